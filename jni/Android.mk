@@ -54,6 +54,8 @@ ifeq ($(core), psx)
 	$(CORE_DIR)/frontio.cpp \
 	$(CORE_DIR)/sio.cpp \
 	$(CORE_DIR)/cpu.cpp \
+	$(CORE_DIR)/cpu_jit.cpp \
+	$(CORE_DIR)/profiler.cpp \
 	$(CORE_DIR)/gte.cpp \
 	$(CORE_DIR)/dis.cpp \
 	$(CORE_DIR)/cdc.cpp \
@@ -430,6 +430,63 @@ void PSX_SetDMASuckSuck(unsigned suckage)
  sucksuck = suckage;
 }
 
+// For the dynarec's inline memory reads.
+const unsigned *PSX_GetDMASuckSuckPtr(void)
+{
+ return &sucksuck;
+}
+
+
+//
+// Which device handles each 32-bit word of the 0x1F801000-0x1F802FFF I/O area, so MemRW() can dispatch on one table lookup
+// instead of walking a chain of range checks.
+//
+enum
+{
+   IOMAP_NONE = 0,
+   IOMAP_SYSCONTROL,
+   IOMAP_FIO,
+   IOMAP_SIO,
+   IOMAP_IRQ,
+   IOMAP_DMA,
+   IOMAP_TIMER,
+   IOMAP_CDC,
+   IOMAP_GPU,
+   IOMAP_MDEC,
+   IOMAP_SPU
+};
+
+static uint8 IOMap[0x2000 >> 2];
+
+static void IOMap_Init(void)
+{
+   static const struct
+   {
+      uint32_t start;
+      uint32_t end;
+      uint8 which;
+   } ranges[] =
+   {
+      { 0x1F801000, 0x1F801023, IOMAP_SYSCONTROL },
+      { 0x1F801040, 0x1F80104F, IOMAP_FIO },
+      { 0x1F801050, 0x1F80105F, IOMAP_SIO },
+      { 0x1F801070, 0x1F801077, IOMAP_IRQ },
+      { 0x1F801080, 0x1F8010FF, IOMAP_DMA },
+      { 0x1F801100, 0x1F80113F, IOMAP_TIMER },
+      { 0x1F801800, 0x1F80180F, IOMAP_CDC },
+      { 0x1F801810, 0x1F801817, IOMAP_GPU },
+      { 0x1F801820, 0x1F801827, IOMAP_MDEC },
+      { 0x1F801C00, 0x1F801FFF, IOMAP_SPU },
+   };
+
+   memset(IOMap, IOMAP_NONE, sizeof(IOMap));
+
+   for(unsigned i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++)
+   {
+      for(uint32_t A = ranges[i].start; A <= ranges[i].end; A += 4)
+         IOMap[(A - 0x1F801000) >> 2] = ranges[i].which;
+   }
+}
 
 // Remember to update MemPeek<>() when we change address decoding in MemRW()
 template<typename T, bool IsWrite, bool Access24> static INLINE void MemRW(pscpu_timestamp_t &timestamp, uint32_t A, uint32_t &V)
@@ -503,207 +560,178 @@ template<typename T, bool IsWrite, bool Access24> static INLINE void MemRW(pscpu
       //else
       // printf("HW Read%d: %08x\n", (unsigned int)(sizeof(T)*8), (unsigned int)A);
 
-      if(A >= 0x1F801C00 && A <= 0x1F801FFF) // SPU
+      switch(IOMap[(A - 0x1F801000) >> 2])
       {
-         if(sizeof(T) == 4 && !Access24)
-         {
-            if(IsWrite)
-            {
-               //timestamp += 15;
-
-               //if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
-               // PSX_EventHandler(timestamp);
+         case IOMAP_NONE:
+            break;
 
-               SPU->Write(timestamp, A | 0, V);
-               SPU->Write(timestamp, A | 2, V >> 16);
-            }
-            else
+         case IOMAP_SPU:
+            if(sizeof(T) == 4 && !Access24)
             {
-               timestamp += 36;
+               if(IsWrite)
+               {
+                  //timestamp += 15;
 
-               if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
-                  PSX_EventHandler(timestamp);
+                  //if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
+                  // PSX_EventHandler(timestamp);
 
-               V = SPU->Read(timestamp, A) | (SPU->Read(timestamp, A | 2) << 16);
-            }
-         }
-         else
-         {
-            if(IsWrite)
-            {
-               //timestamp += 8;
+                  SPU->Write(timestamp, A | 0, V);
+                  SPU->Write(timestamp, A | 2, V >> 16);
+               }
+               else
+               {
+                  timestamp += 36;
 
-               //if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
-               // PSX_EventHandler(timestamp);
+                  if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
+                     PSX_EventHandler(timestamp);
 
-               SPU->Write(timestamp, A & ~1, V);
+                  V = SPU->Read(timestamp, A) | (SPU->Read(timestamp, A | 2) << 16);
+               }
             }
             else
             {
-               timestamp += 16; // Just a guess, need to test.
-
-               if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
-                  PSX_EventHandler(timestamp);
+               if(IsWrite)
+               {
+                  //timestamp += 8;
 
-               V = SPU->Read(timestamp, A & ~1);
-            }
-         }
-         return;
-      }		// End SPU
+                  //if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
+                  // PSX_EventHandler(timestamp);
 
+                  SPU->Write(timestamp, A & ~1, V);
+               }
+               else
+               {
+                  timestamp += 16; // Just a guess, need to test.
 
-      // CDC: TODO - 8-bit access.
-      if(A >= 0x1f801800 && A <= 0x1f80180F)
-      {
-         if(!IsWrite) 
-         {
-            timestamp += 6 * sizeof(T); //24;
-         }
+                  if(timestamp >= events[PSX_EVENT__SYNFIRST].next->event_time)
+                     PSX_EventHandler(timestamp);
 
-         if(IsWrite)
-            CDC->Write(timestamp, A & 0x3, V);
-         else
-            V = CDC->Read(timestamp, A & 0x3);
+                  V = SPU->Read(timestamp, A & ~1);
+               }
+            }
+            return;
 
-         return;
-      }
+         // CDC: TODO - 8-bit access.
+         case IOMAP_CDC:
+            if(!IsWrite) 
+            {
+               timestamp += 6 * sizeof(T); //24;
+            }
 
-      if(A >= 0x1F801810 && A <= 0x1F801817)
-      {
-         if(!IsWrite)
-            timestamp++;
+            if(IsWrite)
+               CDC->Write(timestamp, A & 0x3, V);
+            else
+               V = CDC->Read(timestamp, A & 0x3);
 
-         if(IsWrite)
-            GPU->Write(timestamp, A, V);
-         else
-            V = GPU->Read(timestamp, A);
+            return;
 
-         return;
-      }
+         case IOMAP_GPU:
+            if(!IsWrite)
+               timestamp++;
 
-      if(A >= 0x1F801820 && A <= 0x1F801827)
-      {
-         if(!IsWrite)
-            timestamp++;
+            if(IsWrite)
+               GPU->Write(timestamp, A, V);
+            else
+               V = GPU->Read(timestamp, A);
 
-         if(IsWrite)
-            MDEC_Write(timestamp, A, V);
-         else
-            V = MDEC_Read(timestamp, A);
+            return;
 
-         return;
-      }
+         case IOMAP_MDEC:
+            if(!IsWrite)
+               timestamp++;
 
-      if(A >= 0x1F801000 && A <= 0x1F801023)
-      {
-         unsigned index = (A & 0x1F) >> 2;
+            if(IsWrite)
+               MDEC_Write(timestamp, A, V);
+            else
+               V = MDEC_Read(timestamp, A);
 
-         if(!IsWrite)
-            timestamp++;
+            return;
 
-         //if(A == 0x1F801014 && IsWrite)
-         // fprintf(stderr, "%08x %08x\n",A,V);
+         case IOMAP_SYSCONTROL:
+            {
+               unsigned index = (A & 0x1F) >> 2;
 
-         if(IsWrite)
-         {
-            V <<= (A & 3) * 8;
-            SysControl.Regs[index] = V & SysControl_Mask[index];
-         }
-         else
-         {
-            V = SysControl.Regs[index] | SysControl_OR[index];
-            V >>= (A & 3) * 8;
-         }
-         return;
-      }
+               if(!IsWrite)
+                  timestamp++;
 
-      if(A >= 0x1F801040 && A <= 0x1F80104F)
-      {
-         if(!IsWrite)
-            timestamp++;
+               //if(A == 0x1F801014 && IsWrite)
+               // fprintf(stderr, "%08x %08x\n",A,V);
 
-         if(IsWrite)
-            FIO->Write(timestamp, A, V);
-         else
-            V = FIO->Read(timestamp, A);
-         return;
-      }
+               if(IsWrite)
+               {
+                  V <<= (A & 3) * 8;
+                  SysControl.Regs[index] = V & SysControl_Mask[index];
+               }
+               else
+               {
+                  V = SysControl.Regs[index] | SysControl_OR[index];
+                  V >>= (A & 3) * 8;
+               }
+            }
+            return;
 
-      if(A >= 0x1F801050 && A <= 0x1F80105F)
-      {
-         if(!IsWrite)
-            timestamp++;
+         case IOMAP_FIO:
+            if(!IsWrite)
+               timestamp++;
 
-#if 0
-         if(IsWrite)
-         {
-            PSX_WARNING("[SIO] Write: 0x%08x 0x%08x %u", A, V, (unsigned)sizeof(T));
-         }
-         else
-         {
-            PSX_WARNING("[SIO] Read: 0x%08x", A);
-         }
-#endif
+            if(IsWrite)
+               FIO->Write(timestamp, A, V);
+            else
+               V = FIO->Read(timestamp, A);
+            return;
 
-         if(IsWrite)
-            SIO_Write(timestamp, A, V);
-         else
-            V = SIO_Read(timestamp, A);
-         return;
-      }
+         case IOMAP_SIO:
+            if(!IsWrite)
+               timestamp++;
 
 #if 0
-      if(A >= 0x1F801060 && A <= 0x1F801063)
-      {
-         if(IsWrite)
-         {
-
-         }
-         else
-         {
-
-         }
-
-         return;
-      }
+            if(IsWrite)
+            {
+               PSX_WARNING("[SIO] Write: 0x%08x 0x%08x %u", A, V, (unsigned)sizeof(T));
+            }
+            else
+            {
+               PSX_WARNING("[SIO] Read: 0x%08x", A);
+            }
 #endif
 
-      if(A >= 0x1F801070 && A <= 0x1F801077)	// IRQ
-      {
-         if(!IsWrite)
-            timestamp++;
+            if(IsWrite)
+               SIO_Write(timestamp, A, V);
+            else
+               V = SIO_Read(timestamp, A);
+            return;
 
-         if(IsWrite)
-            IRQ_Write(A, V);
-         else
-            V = IRQ_Read(A);
-         return;
-      }
+         case IOMAP_IRQ:
+            if(!IsWrite)
+               timestamp++;
 
-      if(A >= 0x1F801080 && A <= 0x1F8010FF) 	// DMA
-      {
-         if(!IsWrite)
-            timestamp++;
+            if(IsWrite)
+               IRQ_Write(A, V);
+            else
+               V = IRQ_Read(A);
+            return;
 
-         if(IsWrite)
-            DMA_Write(timestamp, A, V);
-         else
-            V = DMA_Read(timestamp, A);
+         case IOMAP_DMA:
+            if(!IsWrite)
+               timestamp++;
 
-         return;
-      }
+            if(IsWrite)
+               DMA_Write(timestamp, A, V);
+            else
+               V = DMA_Read(timestamp, A);
 
-      if(A >= 0x1F801100 && A <= 0x1F80113F)	// Root counters
-      {
-         if(!IsWrite)
-            timestamp++;
+            return;
 
-         if(IsWrite)
-            TIMER_Write(timestamp, A, V);
-         else
-            V = TIMER_Read(timestamp, A);
+         case IOMAP_TIMER:
+            if(!IsWrite)
+               timestamp++;
+
+            if(IsWrite)
+               TIMER_Write(timestamp, A, V);
+            else
+               V = TIMER_Read(timestamp, A);
 
-         return;
+            return;
       }
    }
 
@@ -838,68 +866,12 @@ template<typename T, bool Access24> static INLINE uint32_t MemPeek(pscpu_timesta
 
    if(A >= 0x1F801000 && A <= 0x1F802FFF)
    {
-      if(A >= 0x1F801C00 && A <= 0x1F801FFF) // SPU
-      {
-         // TODO
-
-      }		// End SPU
-
-
-      // CDC: TODO - 8-bit access.
-      if(A >= 0x1f801800 && A <= 0x1f80180F)
-      {
-         // TODO
-
-      }
-
-      if(A >= 0x1F801810 && A <= 0x1F801817)
-      {
-         // TODO
-
-      }
-
-      if(A >= 0x1F801820 && A <= 0x1F801827)
-      {
-         // TODO
-
-      }
-
-      if(A >= 0x1F801000 && A <= 0x1F801023)
+      // TODO: SPU, CDC, GPU, MDEC, FIO, SIO, IRQ, DMA, root counters
+      if(IOMap[(A - 0x1F801000) >> 2] == IOMAP_SYSCONTROL)
       {
          unsigned index = (A & 0x1F) >> 2;
          return((SysControl.Regs[index] | SysControl_OR[index]) >> ((A & 3) * 8));
       }
-
-      if(A >= 0x1F801040 && A <= 0x1F80104F)
-      {
-         // TODO
-
-      }
-
-      if(A >= 0x1F801050 && A <= 0x1F80105F)
-      {
-         // TODO
-
-      }
-
-
-      if(A >= 0x1F801070 && A <= 0x1F801077)	// IRQ
-      {
-         // TODO
-
-      }
-
-      if(A >= 0x1F801080 && A <= 0x1F8010FF) 	// DMA
-      {
-         // TODO
-
-      }
-
-      if(A >= 0x1F801100 && A <= 0x1F80113F)	// Root counters
-      {
-         // TODO
-
-      }
    }
 
 
@@ -952,6 +924,56 @@ uint32_t PSX_MemPeek32(uint32_t A)
    return MemPeek<uint32, false>(0, A);
 }
 
+#ifdef PSX_MEMRW_BENCHMARK
+//
+// Times MMIO-heavy access patterns through MemRW(); build with -DPSX_MEMRW_BENCHMARK, results go to the log when a game is
+// loaded.  Clobbers emulated state, so the system has to be power-cycled afterwards.
+//
+static void MemRW_Benchmark(void)
+{
+   static const struct
+   {
+      const char *name;
+      uint32_t A[4];
+   } patterns[] =
+   {
+      { "I_STAT poll", { 0x1F801070, 0x1F801070, 0x1F801070, 0x1F801070 } },
+      { "GPUSTAT poll", { 0x1F801814, 0x1F801814, 0x1F801814, 0x1F801814 } },
+      { "DMA regs", { 0x1F8010F0, 0x1F8010F4, 0x1F8010A8, 0x1F8010E8 } },
+      { "root counters", { 0x1F801100, 0x1F801110, 0x1F801120, 0x1F801104 } },
+      { "mixed I/O", { 0x1F801070, 0x1F801814, 0x1F8010F4, 0x1F801014 } },
+   };
+   const unsigned iterations = 1 << 20;
+
+   if(!perf_cb.get_time_usec || !log_cb)
+      return;
+
+   for(unsigned p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++)
+   {
+      retro_time_t start = perf_cb.get_time_usec();
+      uint32_t sum = 0;
+
+      for(unsigned i = 0; i < iterations; i++)
+      {
+         pscpu_timestamp_t timestamp = 0;
+
+         sum += PSX_MemRead32(timestamp, patterns[p].A[i & 3]);
+      }
+
+      log_cb(RETRO_LOG_INFO, "[MemRW] %-14s %6.2f ns/read (%08x)\n", patterns[p].name,
+            (double)(perf_cb.get_time_usec() - start) * 1000 / iterations, sum);
+   }
+}
+#endif
+
+#ifdef PSX_SCANOUT_BENCHMARK
+// Build with -DPSX_SCANOUT_BENCHMARK to log how fast each display line converter is when a game is loaded.
+static void Scanout_BenchmarkReport(const char *mode, const char *kernel, double ns_per_pixel, bool matches)
+{
+   log_cb(RETRO_LOG_INFO, "[Scanout] %s %-6s %6.3f ns/pixel%s\n", mode, kernel, ns_per_pixel, matches ? "" : " (MISMATCH)");
+}
+#endif
+
 // FIXME: Add PSX_Reset() and FrontIO::Reset() so that emulated input devices don't get power-reset on reset-button reset.
 static void PSX_Power(void)
 {
@@ -1010,6 +1032,11 @@ void PSX_GPULineHook(const pscpu_timestamp_t timestamp, const pscpu_timestamp_t
    FIO->GPULineHook(timestamp, line_timestamp, vsync, pixels, format, width, pix_clock_offset, pix_clock, pix_clock_divider);
 }
 
+bool PSX_GPULineHookReadsPixels(void)
+{
+   return FIO->RequireNoFrameskip();
+}
+
 }
 
 using namespace MDFN_IEN_PSX;
@@ -1333,8 +1360,18 @@ static void InitCommon(std::vector<CDIF *> *CDInterfaces, const bool EmulateMemc
    }
 
    CPU = new PS_CPU();
+   CPU->SetCoreMode(MDFN_GetSettingUI("psx.cpu_core"));
+   CPU->SetBIOSHLE(MDFN_GetSettingB("psx.bios_hle"));
+   CPU->SetProfiling(MDFN_GetSettingB("psx.profiler"));
+   GTE_SetLazyFlags(MDFN_GetSettingB("psx.gte_lazy_flags"));
+   PROF_Reset();
    SPU = new PS_SPU();
    GPU = new PS_GPU(region == REGION_EU, sls, sle);
+   GPU->SetBandThreads(MDFN_GetSettingUI("psx.gpu_band_threads"));
+   GPU->SetSpanSIMD(MDFN_GetSettingB("psx.gpu_simd"));
+   GPU->SetTexCacheSize(MDFN_GetSettingUI("psx.gpu_texcache"));
+   GPU->SetDupFrames(MDFN_GetSettingB("psx.gpu_dup_frames"));
+   GPU->SetAsyncRender(MDFN_GetSettingB("psx.gpu_thread"));
    CDC = new PS_CDC();
    FIO = new FrontIO(emulate_memcard, emulate_multitap);
    FIO->SetAMCT(MDFN_GetSettingB("psx.input.analog_mode_ct"));
@@ -1346,6 +1383,7 @@ static void InitCommon(std::vector<CDIF *> *CDInterfaces, const bool EmulateMemc
    }
 
    DMA_Init();
+   IOMap_Init();
 
    GPU->FillVideoParams(&EmulatedPSX);
 
@@ -1437,6 +1475,16 @@ static void InitCommon(std::vector<CDIF *> *CDInterfaces, const bool EmulateMemc
 #endif
 
    PSX_Power();
+
+#ifdef PSX_MEMRW_BENCHMARK
+   MemRW_Benchmark();
+   PSX_Power();
+#endif
+
+#ifdef PSX_SCANOUT_BENCHMARK
+   if(perf_cb.get_time_usec && log_cb)
+      GPU->ScanoutBenchmark(perf_cb.get_time_usec, Scanout_BenchmarkReport);
+#endif
 }
 
 static void LoadEXE(const uint8_t *data, const uint32_t size, bool ignore_pcsp = false)
@@ -1987,6 +2035,24 @@ static double last_sound_rate;
 
 static MDFN_Surface *surf;
 
+// Frame last passed to video_cb, to tell when a duplicate(NULL) frame can be passed instead.
+static bool can_dupe;
+static const ScanoutPixel *prev_video_pix;
+static unsigned prev_video_width, prev_video_height;
+
+// setting_psx_frameskip is how many frames to skip after each one displayed, or FRAMESKIP_AUTO to skip while the frontend is fast
+// forwarding or about to run out of audio.
+#define FRAMESKIP_AUTO 0xFFFFFFFF
+#define FRAMESKIP_AUTO_MAX 3	// Most frames skipped in a row.
+static bool frameskip_next;
+static unsigned frameskip_count;
+static bool audio_underrun_likely;
+
+static void audio_buffer_status(bool active, unsigned occupancy, bool underrun_likely)
+{
+   audio_underrun_likely = active && underrun_likely;
+}
+
 static bool failed_init;
 
 char *psx_analog_type;
@@ -2302,6 +2368,173 @@ static void check_variables(void)
       else if (strcmp(var.value, "disabled") == 0)
          setting_psx_multitap_port_2 = false;
    }
+
+   var.key = "psx_cpu_core";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      uint32_t core = setting_psx_cpu_core;
+
+      if (strcmp(var.value, "interpreter") == 0)
+         core = PS_CPU::CORE_INTERPRETER;
+      else if (strcmp(var.value, "cached interpreter") == 0)
+         core = PS_CPU::CORE_CACHED_INTERPRETER;
+      else if (strcmp(var.value, "dynarec") == 0)
+         core = PS_CPU::CORE_DYNAREC;
+
+      if (core != setting_psx_cpu_core)
+      {
+         setting_psx_cpu_core = core;
+         if (CPU)
+            CPU->SetCoreMode(setting_psx_cpu_core);
+      }
+   }
+
+   var.key = "psx_bios_hle";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_bios_hle = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_bios_hle = 0;
+
+      if (CPU)
+         CPU->SetBIOSHLE(setting_psx_bios_hle);
+   }
+
+   var.key = "psx_profiler";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_profiler = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_profiler = 0;
+
+      if (CPU)
+         CPU->SetProfiling(setting_psx_profiler);
+   }
+
+   var.key = "psx_gte_lazy_flags";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_gte_lazy_flags = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_gte_lazy_flags = 0;
+
+      if (CPU)
+         GTE_SetLazyFlags(setting_psx_gte_lazy_flags);
+   }
+
+   var.key = "psx_gpu_thread";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_gpu_thread = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_gpu_thread = 0;
+
+      if (GPU)
+         GPU->SetAsyncRender(setting_psx_gpu_thread);
+   }
+
+   var.key = "psx_gpu_band_threads";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      setting_psx_gpu_band_threads = atoi(var.value);
+
+      if (GPU)
+         GPU->SetBandThreads(setting_psx_gpu_band_threads);
+   }
+
+   var.key = "psx_gpu_simd";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_gpu_simd = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_gpu_simd = 0;
+
+      if (GPU)
+         GPU->SetSpanSIMD(setting_psx_gpu_simd);
+   }
+
+   var.key = "psx_gpu_dup_frames";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_gpu_dup_frames = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_gpu_dup_frames = 0;
+
+      if (GPU)
+         GPU->SetDupFrames(setting_psx_gpu_dup_frames);
+   }
+
+   var.key = "psx_gpu_texcache";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      setting_psx_gpu_texcache = atoi(var.value);
+
+      if (GPU)
+         GPU->SetTexCacheSize(setting_psx_gpu_texcache);
+   }
+
+   var.key = "psx_frameskip";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_psx_frameskip = 0;
+      else if (strcmp(var.value, "auto") == 0)
+         setting_psx_frameskip = FRAMESKIP_AUTO;
+      else
+         setting_psx_frameskip = atoi(var.value);
+   }
+
+   var.key = "psx_gpu_record";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      if (strcmp(var.value, "enabled") == 0)
+         setting_psx_gpu_record = 1;
+      else if (strcmp(var.value, "disabled") == 0)
+         setting_psx_gpu_record = 0;
+   }
+
+   var.key = "psx_audio_rate";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+   {
+      const uint32_t rate = atoi(var.value);
+
+      if (rate && rate != setting_psx_audio_rate)
+      {
+         setting_psx_audio_rate = rate;
+
+         // Changing it with a game running means telling the frontend.
+         if (SPU)
+         {
+            struct retro_system_av_info av_info;
+
+            retro_get_system_av_info(&av_info);
+            environ_cb(RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO, &av_info);
+         }
+      }
+   }
+
+   var.key = "psx_audio_resamp_quality";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+      setting_psx_spu_resamp_quality = atoi(var.value);
 }
 
 #ifdef NEED_CD
@@ -2567,6 +2800,20 @@ bool retro_load_game(const struct retro_game_info *info)
    if (environ_cb(RETRO_ENVIRONMENT_GET_RUMBLE_INTERFACE, &rumble) && log_cb)
       log_cb(RETRO_LOG_INFO, "Rumble interface supported!\n");
 
+   can_dupe = false;
+   environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &can_dupe);
+   prev_video_pix = NULL;
+
+   {
+      struct retro_audio_buffer_status_callback buf_status = { audio_buffer_status };
+
+      audio_underrun_likely = false;
+      environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &buf_status);
+   }
+
+   frameskip_next = false;
+   frameskip_count = 0;
+
    if (!MDFNI_LoadGame(MEDNAFEN_CORE_NAME_MODULE, info->path))
       return false;
 
@@ -2592,6 +2839,41 @@ void retro_unload_game(void)
 
    MDFN_FlushGameCheats(0);
 
+   if (PROF_HaveSamples())
+   {
+      // Symbols for the profile come from "<content name>.sym" in the save directory, independent of the disc's MD5
+      // so that one map can serve every build of a game.
+#ifdef _WIN32
+      std::string sym_path = retro_save_directory + '\\' + retro_base_name + ".sym";
+#else
+      std::string sym_path = retro_save_directory + '/' + retro_base_name + ".sym";
+#endif
+
+      PROF_Dump(MDFN_MakeFName(MDFNMKF_SAV, 0, "prof.txt").c_str(), MDFN_MakeFName(MDFNMKF_SAV, 0, "prof.folded").c_str(), sym_path.c_str());
+      PROF_Reset();
+   }
+
+   if (GPU)
+   {
+      PS_GPU::TexCacheStats tcs;
+
+      GPU->GetTexCacheStats(&tcs);
+
+      if (tcs.entries && log_cb)
+         log_cb(RETRO_LOG_INFO, "Texture cache (%u entries): %llu hits, %llu misses, %llu evictions, %llu invalidations.\n", tcs.entries,
+               (unsigned long long)tcs.hits, (unsigned long long)tcs.misses, (unsigned long long)tcs.evictions, (unsigned long long)tcs.invalidations);
+
+      PS_GPU::SkipDrawStats sds;
+
+      GPU->GetSkipDrawStats(&sds);
+
+      if (sds.deferred && log_cb)
+         log_cb(RETRO_LOG_INFO, "Frameskip: %llu drawing commands put off, %llu of them drawn over, %llu drawn later.\n",
+               (unsigned long long)sds.deferred, (unsigned long long)sds.dropped, (unsigned long long)sds.drawn);
+   }
+
+   environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+
    MDFNGameInfo->CloseGame();
 
    if(MDFNGameInfo->name)
@@ -2696,6 +2978,7 @@ static void update_input(void)
 }
 
 static uint64_t video_frames, audio_frames;
+static int16_t audio_buf[PS_SPU::EndFrameMaxFrames * 2];
 
 #define SOUND_CHANNELS 2
 
@@ -2720,7 +3003,7 @@ void retro_run(void)
 
    EmulateSpecStruct spec = {0};
    spec.surface = surf;
-   spec.SoundRate = 44100;
+   spec.SoundRate = setting_psx_audio_rate;
    spec.SoundBuf = NULL;
    spec.LineWidths = rects;
    spec.SoundBufMaxSize = 0;
@@ -2734,7 +3017,40 @@ void retro_run(void)
    /* start of Emulate */
    pscpu_timestamp_t timestamp = 0;
 
-   espec->skip = false;	
+   // Decided a frame ahead, since what's drawn during a frame is what the next one displays.
+   espec->skip = frameskip_next;
+   frameskip_next = false;
+
+   if (setting_psx_frameskip && !FIO->RequireNoFrameskip())
+   {
+      if (setting_psx_frameskip == FRAMESKIP_AUTO)
+      {
+         bool fast_forwarding = false;
+
+         environ_cb(RETRO_ENVIRONMENT_GET_FASTFORWARDING, &fast_forwarding);
+         frameskip_next = (fast_forwarding || audio_underrun_likely) && frameskip_count < FRAMESKIP_AUTO_MAX;
+      }
+      else
+         frameskip_next = frameskip_count < setting_psx_frameskip;
+   }
+
+   frameskip_count = frameskip_next ? (frameskip_count + 1) : 0;
+
+   // Recordings(for tools/gpu_replay) start and stop on frame boundaries.
+   if (setting_psx_gpu_record != GPU->IsRecording())
+   {
+      if (!setting_psx_gpu_record)
+         GPU->StopRecording();
+      else if (!GPU->StartRecording(MDFN_MakeFName(MDFNMKF_SAV, 0, "gpurec").c_str()))
+      {
+         if (log_cb)
+            log_cb(RETRO_LOG_WARN, "[mednafen]: Couldn't start GPU recording.\n");
+         setting_psx_gpu_record = 0;
+      }
+   }
+
+   GPU->SetSkipDraw(frameskip_next);
+
    MDFNGameInfo->mouse_sensitivity = MDFN_GetSettingF("psx.input.mouse_sensitivity");
 
    MDFNMP_ApplyPeriodicCheats();
@@ -2745,6 +3061,7 @@ void retro_run(void)
 
    FIO->UpdateInput();
    GPU->StartFrame(espec);
+   SPU->StartFrame(setting_psx_audio_rate, MDFN_GetSettingUI("psx.spu.resamp_quality"));
 
    Running = -1;
    timestamp = CPU->Run(timestamp, false);
@@ -2757,7 +3074,7 @@ void retro_run(void)
 
    //printf("scanline=%u, st=%u\n", GPU->GetScanlineNum(), timestamp);
 
-   espec->SoundBufSize = IntermediateBufferPos;
+   espec->SoundBufSize = SPU->EndFrame(audio_buf);
    IntermediateBufferPos = 0;
 
    CDC->ResetTS();
@@ -2808,6 +3125,9 @@ void retro_run(void)
 
    /* end of Emulate */
 
+   GPU->SyncRender();
+   GPU->RecordFrameEnd();
+
 #ifdef NEED_DEINTERLACER
    if (spec.InterlaceOn)
    {
@@ -2825,8 +3145,6 @@ void retro_run(void)
       PrevInterlaced = false;
 #endif
 
-   int16_t *interbuf = (int16_t*)&IntermediateBuffer;
-
    // PSX is rather special, and needs specific handling ...
    
    unsigned width = rects[0]; // spec.DisplayRect.w is 0. Only rects[0].w seems to return something sane.
@@ -2834,7 +3152,10 @@ void retro_run(void)
    //fprintf(stderr, "(%u x %u)\n", width, height);
    // PSX core inserts padding on left and right (overscan). Optionally crop this.
 
-   const uint32_t *pix = surf->pixels;
+   // 16bpp builds have the pixels of each line packed into the first half of it(see ScanoutPixel).
+   const ScanoutPixel *pix = (const ScanoutPixel *)surf->pixels;
+   const unsigned pitch = MEDNAFEN_CORE_GEOMETRY_MAX_W * sizeof(uint32_t) / sizeof(ScanoutPixel);
+
    if (!overscan)
    {
       // 320 width -> 350 width.
@@ -2883,15 +3204,27 @@ void retro_run(void)
          // These numbers are arbitrary since the bars differ some by game.
          // Changes aspect ratio in the process.
          height -= 36;
-         pix += 5 * (MEDNAFEN_CORE_GEOMETRY_MAX_W << 2);
+         pix += 5 * (pitch << 2);
       }
    }
-   video_cb(pix, width, height, MEDNAFEN_CORE_GEOMETRY_MAX_W << 2);
+   // Skipped frames leave the surface as it was.
+   const bool unchanged = GPU->FrameUnchanged();
+
+   if (can_dupe && (spec.skip || (unchanged && pix == prev_video_pix && width == prev_video_width && height == prev_video_height)))
+      video_cb(NULL, width, height, MEDNAFEN_CORE_GEOMETRY_MAX_W << 2);
+   else
+   {
+      video_cb(pix, width, height, MEDNAFEN_CORE_GEOMETRY_MAX_W << 2);
+
+      prev_video_pix = pix;
+      prev_video_width = width;
+      prev_video_height = height;
+   }
 
    video_frames++;
    audio_frames += spec.SoundBufSize;
 
-   audio_batch_cb(interbuf, spec.SoundBufSize);
+   audio_batch_cb(audio_buf, spec.SoundBufSize);
 }
 
 void retro_get_system_info(struct retro_system_info *info)
@@ -2908,7 +3241,7 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 {
    memset(info, 0, sizeof(*info));
    info->timing.fps            = (CalcDiscSCEx() == REGION_EU) ? 49.842 : 59.941;
-   info->timing.sample_rate    = 44100;
+   info->timing.sample_rate    = setting_psx_audio_rate;
    info->geometry.base_width   = MEDNAFEN_CORE_GEOMETRY_BASE_W;
    info->geometry.base_height  = MEDNAFEN_CORE_GEOMETRY_BASE_H;
    info->geometry.max_width    = MEDNAFEN_CORE_GEOMETRY_MAX_W;
@@ -2926,7 +3259,7 @@ void retro_deinit(void)
       log_cb(RETRO_LOG_INFO, "[%s]: Samples / Frame: %.5f\n",
             MEDNAFEN_CORE_NAME, (double)audio_frames / video_frames);
       log_cb(RETRO_LOG_INFO, "[%s]: Estimated FPS: %.5f\n",
-            MEDNAFEN_CORE_NAME, (double)video_frames * 44100 / audio_frames);
+            MEDNAFEN_CORE_NAME, (double)video_frames * setting_psx_audio_rate / audio_frames);
    }
 }
 
@@ -2989,6 +3322,19 @@ void retro_set_environment(retro_environment_t cb)
       { "psx_enable_analog_toggle", "Dualshock analog button; disabled|enabled" },
       { "psx_enable_multitap_port1", "Port 1: Multitap enable; disabled|enabled" },
       { "psx_enable_multitap_port2", "Port 2: Multitap enable; disabled|enabled" },
+      { "psx_cpu_core", "CPU core; interpreter|cached interpreter|dynarec" },
+      { "psx_bios_hle", "BIOS HLE; disabled|enabled" },
+      { "psx_profiler", "CPU profiler; disabled|enabled" },
+      { "psx_gte_lazy_flags", "GTE lazy FLAG register; disabled|enabled" },
+      { "psx_gpu_thread", "GPU render thread; disabled|enabled" },
+      { "psx_gpu_band_threads", "GPU rasterizer threads; 1|2|3|4|6|8" },
+      { "psx_gpu_simd", "GPU SIMD span rasterizer; enabled|disabled" },
+      { "psx_gpu_texcache", "GPU texture page cache entries; 16|32|64|0|8" },
+      { "psx_gpu_dup_frames", "Skip unchanged frames; enabled|disabled" },
+      { "psx_frameskip", "Frameskip; disabled|auto|1|2|3" },
+      { "psx_gpu_record", "GPU command recorder; disabled|enabled" },
+      { "psx_audio_rate", "Audio output rate; 44100|48000|96000|32000|88200" },
+      { "psx_audio_resamp_quality", "Audio resampler quality; 4|5|6|7|8|9|10|0|1|2|3" },
 	  
 
       { NULL, NULL },
@@ -3238,3 +3584,25 @@ int MDFND_UnlockMutex(MDFN_Mutex *lock)
    slock_unlock((slock_t*)lock);
    return 0;
 }
+
+MDFN_Cond *MDFND_CreateCond()
+{
+   return (MDFN_Cond*)scond_new();
+}
+
+void MDFND_DestroyCond(MDFN_Cond *cond)
+{
+   scond_free((scond_t*)cond);
+}
+
+int MDFND_WaitCond(MDFN_Cond *cond, MDFN_Mutex *lock)
+{
+   scond_wait((scond_t*)cond, (slock_t*)lock);
+   return 0;
+}
+
+int MDFND_SignalCond(MDFN_Cond *cond)
+{
+   scond_signal((scond_t*)cond);
+   return 0;
+}
@@ -637,6 +637,15 @@ enum retro_mod
                                            // The core must pass an array of const struct retro_controller_info which is terminated with
                                            // a blanked out struct. Each element of the struct corresponds to an ascending port index to retro_set_controller_port_device().
                                            // Even if special device types are set in the libretro core, libretro should only poll input based on the base input device types.
+#define RETRO_ENVIRONMENT_GET_FASTFORWARDING (49 | RETRO_ENVIRONMENT_EXPERIMENTAL)
+                                           // bool * --
+                                           // Boolean value that indicates whether or not the frontend is in fastforwarding mode.
+                                           //
+#define RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK 62
+                                           // const struct retro_audio_buffer_status_callback * --
+                                           // Lets the core know the occupancy level of the frontend audio buffer, e.g. to decide when to skip frames.
+                                           // Can be called with NULL to stop the frontend from calling it.
+                                           //
 
 struct retro_controller_description
 {
@@ -975,6 +984,15 @@ struct retro_frame_time_callback
    retro_usec_t reference; // Represents the time of one frame. It is computed as 1000000 / fps, but the implementation will resolve the rounding to ensure that framestepping, etc is exact.
 };
 
+// Notifies the core of the frontend audio buffer status.
+// active: whether audio is enabled at all; occupancy: how full the buffer is, in percent; underrun_likely: whether the frontend
+// expects the buffer to run out if the core doesn't speed up.
+typedef void (*retro_audio_buffer_status_callback_t)(bool active, unsigned occupancy, bool underrun_likely);
+struct retro_audio_buffer_status_callback
+{
+   retro_audio_buffer_status_callback_t callback;
+};
+
 // Pass this to retro_video_refresh_t if rendering to hardware.
 // Passing NULL to retro_video_refresh_t is still a frame dupe as normal.
 #define RETRO_HW_FRAME_BUFFER_VALID ((void*)-1)
@@ -17,6 +17,7 @@
 
 #include "psx.h"
 #include "cpu.h"
+#include "cpu_jit.h"
 
 /* TODO
 	Make sure load delays are correct.
@@ -48,12 +49,81 @@ PS_CPU::PS_CPU()
 
    CPUHook = NULL;
    ADDBT = NULL;
+
+   CoreMode = CORE_INTERPRETER;
+   JIT = NULL;
+   JIT_timestamp = 0;
+
+   HLE_Enabled = false;
+   Profiling = false;
+
+   ICache_NextPC = ~0U;
+
+   EventSerial = 0;
+   memset(&IdleLoop, 0, sizeof(IdleLoop));
+
+   GTE_Init();
+
+   CI_Blocks = NULL;
+   CI_Pool = NULL;
+   CI_PoolUsed = 0;
 }
 
 PS_CPU::~PS_CPU()
 {
+   if(JIT)
+   {
+      delete JIT;
+      JIT = NULL;
+   }
+
+   CI_Kill();
+}
+
+void PS_CPU::SetCoreMode(unsigned mode)
+{
+   CoreMode = CORE_INTERPRETER;
+
+   if(mode == CORE_CACHED_INTERPRETER)
+   {
+      if(!CI_Blocks && !CI_Init())
+      {
+         PSX_WARNING("[CPU] Unable to allocate cached interpreter block memory, using the interpreter.");
+         CI_Kill();
+      }
+      else
+         CoreMode = CORE_CACHED_INTERPRETER;
+   }
+
+#ifdef PS_CPU_HAVE_JIT
+   if(mode == CORE_DYNAREC)
+   {
+      if(!JIT)
+      {
+         JIT = new PS_CPU_JIT(this);
+
+         if(!JIT->Init())
+         {
+            PSX_WARNING("[CPU] Unable to allocate dynarec code cache, using the interpreter.");
+            delete JIT;
+            JIT = NULL;
+         }
+      }
+
+      if(JIT)
+         CoreMode = CORE_DYNAREC;
+   }
+#endif
+}
 
+void PS_CPU::SetBIOSHLE(bool enabled)
+{
+   HLE_Enabled = enabled;
+}
 
+void PS_CPU::SetProfiling(bool enabled)
+{
+   Profiling = enabled;
 }
 
 void PS_CPU::SetFastMap(void *region_mem, uint32_t region_address, uint32_t region_size)
@@ -127,6 +197,7 @@ void PS_CPU::Power(void)
       ICache[i].TV = 0x2 | ((BIU & 0x800) ? 0x0 : 0x1);
       ICache[i].Data = 0;
    }
+   ICache_NextPC = ~0U;
 
    GTE_Power();
 }
@@ -173,7 +244,7 @@ int PS_CPU::StateAction(StateMem *sm, int load, int data_only)
 
    if(load)
    {
-
+      ICache_NextPC = ~0U;
    }
 
    return(ret);
@@ -210,6 +281,7 @@ void PS_CPU::SetBIU(uint32_t val)
          for(i = 0; i < 1024; i++)
             ICache[i].TV |= 0x1;
       }
+      ICache_NextPC = ~0U;
    }
 
    PSX_DBG(PSX_DBG_SPARSE, "[CPU] Set BIU=0x%08x\n", BIU);
@@ -352,6 +424,7 @@ INLINE void PS_CPU::WriteMemory(pscpu_timestamp_t &timestamp, uint32_t address,
             ICI[1].TV = ((valid_bits & 0x02) ? 0x00 : 0x02) | ((BIU & 0x800) ? 0x0 : 0x1);
             ICI[2].TV = ((valid_bits & 0x04) ? 0x00 : 0x02) | ((BIU & 0x800) ? 0x0 : 0x1);
             ICI[3].TV = ((valid_bits & 0x08) ? 0x00 : 0x02) | ((BIU & 0x800) ? 0x0 : 0x1);
+            ICache_NextPC = ~0U;
          }
          else if(!(BIU & 0x1))
          {
@@ -428,10 +501,11 @@ uint32_t PS_CPU::Exception(uint32_t code, uint32_t PC, const uint32_t NPM)
 #define GPR_RES(n) { unsigned tn = (n); ReadAbsorb[tn] = 0; }
 #define GPR_DEPRES_END ReadAbsorb[0] = back; }
 
-template<bool DebugMode, bool ILHMode>
+template<bool DebugMode, bool ILHMode, unsigned XlatMode>
 pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
 {
    register pscpu_timestamp_t timestamp = timestamp_in;
+   pscpu_timestamp_t prof_timestamp = timestamp_in;
 
    register uint32_t PC;
    register uint32_t new_PC;
@@ -457,6 +531,31 @@ pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
          // Zero must be zero...until the Master Plan is enacted.
          GPR[0] = 0;
 
+         // Translated blocks are only entered on a clean instruction boundary; the interpreter handles interrupts,
+         // branch delay slots and anything the block can't.
+         if(XlatMode != CORE_INTERPRETER && new_PC_mask == ~0U && !IPCache)
+         {
+            bool ran;
+
+            ACTIVE_TO_BACKING;
+            JIT_timestamp = timestamp;
+            ICache_NextPC = ~0U;
+
+#ifdef PS_CPU_HAVE_JIT
+            if(XlatMode == CORE_DYNAREC)
+               ran = JIT->Execute();
+            else
+#endif
+               ran = CI_Execute();
+
+            if(ran)
+            {
+               timestamp = JIT_timestamp;
+               BACKING_TO_ACTIVE;
+               continue;
+            }
+         }
+
          if(DebugMode && CPUHook)
          {
             ACTIVE_TO_BACKING;
@@ -483,11 +582,22 @@ pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
                   PSX_DBG(PSX_DBG_BIOS_PRINT, "%c", GPR[4]);
                }
             }
+
+            // Only on a clean instruction boundary; an interrupt or a pending load is left to the real BIOS code.
+            if(MDFN_UNLIKELY(HLE_Enabled) && (PC == 0xA0 || PC == 0xB0) && new_PC_mask == ~0U && LDWhich == 0x20 && !IPCache)
+            {
+               if(HLE_Call(PC, timestamp))
+               {
+                  PC = GPR[31];
+                  continue;
+               }
+            }
          }
 
          instr = ICache[(PC & 0xFFC) >> 2].Data;
 
-         if(ICache[(PC & 0xFFC) >> 2].TV != PC)
+         // Tags only need checking at the start of a line, or after a jump; see ICache_NextPC.
+         if((PC != ICache_NextPC || !(PC & 0xC)) && ICache[(PC & 0xFFC) >> 2].TV != PC)
          {
             //WriteAbsorb = 0;
             //WriteAbsorbCount = 0;
@@ -500,6 +610,7 @@ pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
             {
                instr = LoadU32_LE((uint32_t *)&FastMap[PC >> FAST_MAP_SHIFT][PC]);
                timestamp += 4;	// Approximate best-case cache-disabled time, per PS1 tests(executing out of 0xA0000000+); it can be 5 in *some* sequences of code(like a lot of sequential "nop"s, probably other simple instructions too).
+               ICache_NextPC = ~0U;
             }
             else
             {
@@ -535,8 +646,11 @@ pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
                      break;
                }
                instr = ICache[(PC & 0xFFC) >> 2].Data;
+               ICache_NextPC = PC + 4;
             }
          }
+         else
+            ICache_NextPC = PC + 4;
 
          //printf("PC=%08x, SP=%08x - op=0x%02x - funct=0x%02x - instr=0x%08x\n", PC, GPR[29], instr >> 26, instr & 0x3F, instr);
          //for(int i = 0; i < 32; i++)
@@ -608,6 +722,8 @@ pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
             goto SkipNPCStuff;				\
          }
 
+#define DO_EXCEPTION(code) { new_PC = Exception((code), PC, new_PC_mask); new_PC_mask = 0; }
+
 #define ITYPE uint32_t rs MDFN_NOWARN_UNUSED = (instr >> 21) & 0x1F; uint32_t rt MDFN_NOWARN_UNUSED = (instr >> 16) & 0x1F; int32_t immediate = (int16)(instr & 0xFFFF); /*printf(" rs=%02x(%08x), rt=%02x(%08x), immediate=(%08x) ", rs, GPR[rs], rt, GPR[rt], immediate);*/
 #define ITYPE_ZE uint32_t rs MDFN_NOWARN_UNUSED = (instr >> 21) & 0x1F; uint32_t rt MDFN_NOWARN_UNUSED = (instr >> 16) & 0x1F; uint32_t immediate = instr & 0xFFFF; /*printf(" rs=%02x(%08x), rt=%02x(%08x), immediate=(%08x) ", rs, GPR[rs], rt, GPR[rt], immediate);*/
 #define JTYPE uint32_t target = instr & ((1 << 26) - 1); /*printf(" target=(%08x) ", target);*/
@@ -658,1584 +774,203 @@ pscpu_timestamp_t PS_CPU::RunReal(pscpu_timestamp_t timestamp_in)
 
          {
             BEGIN_OPF(ILL, 0, 0);
-            PSX_WARNING("[CPU] Unknown instruction @%08x = %08x, op=%02x, funct=%02x", PC, instr, instr >> 26, (instr & 0x3F));
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_RI, PC, new_PC_mask);
-            new_PC_mask = 0;
-            END_OPF;
-
-            //
-            // ADD - Add Word
-            //
-            BEGIN_OPF(ADD, 0, 0x20);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] + GPR[rt];
-            bool ep = ((~(GPR[rs] ^ GPR[rt])) & (GPR[rs] ^ result)) & 0x80000000;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(ep))
-            {
-               new_PC = Exception(EXCEPTION_OV, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-               GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // ADDI - Add Immediate Word
-            //
-            BEGIN_OPF(ADDI, 0x08, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] + immediate;
-            bool ep = ((~(GPR[rs] ^ immediate)) & (GPR[rs] ^ result)) & 0x80000000;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(ep))
-            {
-               new_PC = Exception(EXCEPTION_OV, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-               GPR[rt] = result;
-
-            END_OPF;
-
-            //
-            // ADDIU - Add Immediate Unsigned Word
-            //
-            BEGIN_OPF(ADDIU, 0x09, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            GPR[rt] = result;
-
-            END_OPF;
-
-            //
-            // ADDU - Add Unsigned Word
-            //
-            BEGIN_OPF(ADDU, 0, 0x21);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] + GPR[rt];
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // AND - And
-            //
-            BEGIN_OPF(AND, 0, 0x24);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] & GPR[rt];
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // ANDI - And Immediate
-            //
-            BEGIN_OPF(ANDI, 0x0C, 0);
-            ITYPE_ZE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] & immediate;
-
-            DO_LDS();
-
-            GPR[rt] = result;
-
-            END_OPF;
-
-            //
-            // BEQ - Branch on Equal
-            //
-            BEGIN_OPF(BEQ, 0x04, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               bool result = (GPR[rs] == GPR[rt]);
-
-            DO_LDS();
-
-            if(result)
-            {
-               DO_BRANCH((immediate << 2), ~0U);
-            }
-            END_OPF;
-
-            // Bah, why does MIPS encoding have to be funky like this. :(
-            // Handles BGEZ, BGEZAL, BLTZ, BLTZAL
-            BEGIN_OPF(BCOND, 0x01, 0);
-            const uint32_t tv = GPR[(instr >> 21) & 0x1F];
-            uint32_t riv = (instr >> 16) & 0x1F;
-            int32_t immediate = (int16)(instr & 0xFFFF);
-            bool result = (int32)(tv ^ (riv << 31)) < 0;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP((instr >> 21) & 0x1F);
-
-            if(riv & 0x10)
-               GPR_RES(31);
-
-            GPR_DEPRES_END
-
-
+               PSX_WARNING("[CPU] Unknown instruction @%08x = %08x, op=%02x, funct=%02x", PC, instr, instr >> 26, (instr & 0x3F));
                DO_LDS();
-
-            if(riv & 0x10)	// Unconditional link reg setting.
-               GPR[31] = PC + 8;
-
-            if(result)
-            {
-               DO_BRANCH((immediate << 2), ~0U);
-            }
-
-            END_OPF;
-
-
-            //
-            // BGTZ - Branch on Greater than Zero
-            //
-            BEGIN_OPF(BGTZ, 0x07, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               bool result = (int32)GPR[rs] > 0;
-
-            DO_LDS();
-
-            if(result)
-            {
-               DO_BRANCH((immediate << 2), ~0U);
-            }
-            END_OPF;
-
-            //
-            // BLEZ - Branch on Less Than or Equal to Zero
-            //
-            BEGIN_OPF(BLEZ, 0x06, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               bool result = (int32)GPR[rs] <= 0;
-
-            DO_LDS();
-
-            if(result)
-            {
-               DO_BRANCH((immediate << 2), ~0U);
-            }
-
-            END_OPF;
-
-            //
-            // BNE - Branch on Not Equal
-            //
-            BEGIN_OPF(BNE, 0x05, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               bool result = GPR[rs] != GPR[rt];
-
-            DO_LDS();
-
-            if(result)
-            {
-               DO_BRANCH((immediate << 2), ~0U);
-            }
-
+               DO_EXCEPTION(EXCEPTION_RI);
             END_OPF;
 
             //
             // BREAK - Breakpoint
             //
             BEGIN_OPF(BREAK, 0, 0x0D);
-            PSX_WARNING("[CPU] BREAK BREAK BREAK BREAK DAAANCE -- PC=0x%08x", PC);
+               PSX_WARNING("[CPU] BREAK BREAK BREAK BREAK DAAANCE -- PC=0x%08x", PC);
 
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_BP, PC, new_PC_mask);
-            new_PC_mask = 0;
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_BP);
             END_OPF;
 
             // Cop "instructions":	CFCz(no CP0), COPz, CTCz(no CP0), LWCz(no CP0), MFCz, MTCz, SWCz(no CP0)
             //
             // COP0 instructions
             BEGIN_OPF(COP0, 0x10, 0);
-            uint32_t sub_op = (instr >> 21) & 0x1F;
-
-            if(sub_op & 0x10)
-               sub_op = 0x10 + (instr & 0x3F);
+               uint32_t sub_op = (instr >> 21) & 0x1F;
 
-            //printf("COP0 thing: %02x\n", sub_op);
-            switch(sub_op)
-            {
-               default:
-                  DO_LDS();
-                  break;
+               if(sub_op & 0x10)
+                  sub_op = 0x10 + (instr & 0x3F);
 
-               case 0x00:		// MFC0	- Move from Coprocessor
-                  {
-                     uint32_t rt = (instr >> 16) & 0x1F;
-                     uint32_t rd = (instr >> 11) & 0x1F;
-
-                     //printf("MFC0: rt=%d <- rd=%d(%08x)\n", rt, rd, CP0.Regs[rd]);
+               switch(sub_op)
+               {
+                  default:
                      DO_LDS();
+                     break;
 
-                     LDAbsorb = 0;
-                     LDWhich = rt;
-                     LDValue = CP0.Regs[rd];
-                  }
-                  break;
+                  case 0x00:		// MFC0	- Move from Coprocessor
+                     {
+                        uint32_t rt = (instr >> 16) & 0x1F;
+                        uint32_t rd = (instr >> 11) & 0x1F;
 
-               case 0x04:		// MTC0	- Move to Coprocessor
-                  {
-                     uint32_t rt = (instr >> 16) & 0x1F;
-                     uint32_t rd = (instr >> 11) & 0x1F;
-                     uint32_t val = GPR[rt];
+                        DO_LDS();
 
-                     if(rd != CP0REG_PRID && rd != CP0REG_CAUSE && rd != CP0REG_SR && val)
-                     {
-                        PSX_WARNING("[CPU] Unimplemented MTC0: rt=%d(%08x) -> rd=%d", rt, GPR[rt], rd);
+                        LDAbsorb = 0;
+                        LDWhich = rt;
+                        LDValue = CP0.Regs[rd];
                      }
+                     break;
 
-                     switch(rd)
+                  case 0x04:		// MTC0	- Move to Coprocessor
                      {
-                        case CP0REG_BPC:
-                           CP0.BPC = val;
-                           break;
-
-                        case CP0REG_BDA:
-                           CP0.BDA = val;
-                           break;
-
-                        case CP0REG_TAR:
-                           CP0.TAR = val;
-                           break;
-
-                        case CP0REG_DCIC:
-                           CP0.DCIC = val & 0xFF80003F;
-                           break;
-
-                        case CP0REG_BDAM:
-                           CP0.BDAM = val;
-                           break;
-
-                        case CP0REG_BPCM:
-                           CP0.BPCM = val;
-                           break;
-
-                        case CP0REG_CAUSE:
-                           CP0.CAUSE &= ~(0x3 << 8);
-                           CP0.CAUSE |= val & (0x3 << 8);
-                           RecalcIPCache();
-                           break;
-
-                        case CP0REG_SR:
-                           if((CP0.SR ^ val) & 0x10000)
-                              PSX_DBG(PSX_DBG_SPARSE, "[CPU] IsC %u->%u\n", (bool)(CP0.SR & (1U << 16)), (bool)(val & (1U << 16)));
-
-                           CP0.SR = val & ~( (0x3 << 26) | (0x3 << 23) | (0x3 << 6));
-                           RecalcIPCache();
-                           break;
+                        uint32_t rt = (instr >> 16) & 0x1F;
+                        uint32_t rd = (instr >> 11) & 0x1F;
+                        uint32_t val = GPR[rt];
+
+                        if(rd != CP0REG_PRID && rd != CP0REG_CAUSE && rd != CP0REG_SR && val)
+                        {
+                           PSX_WARNING("[CPU] Unimplemented MTC0: rt=%d(%08x) -> rd=%d", rt, GPR[rt], rd);
+                        }
+
+                        switch(rd)
+                        {
+                           case CP0REG_BPC:
+                              CP0.BPC = val;
+                              break;
+
+                           case CP0REG_BDA:
+                              CP0.BDA = val;
+                              break;
+
+                           case CP0REG_TAR:
+                              CP0.TAR = val;
+                              break;
+
+                           case CP0REG_DCIC:
+                              CP0.DCIC = val & 0xFF80003F;
+                              break;
+
+                           case CP0REG_BDAM:
+                              CP0.BDAM = val;
+                              break;
+
+                           case CP0REG_BPCM:
+                              CP0.BPCM = val;
+                              break;
+
+                           case CP0REG_CAUSE:
+                              CP0.CAUSE &= ~(0x3 << 8);
+                              CP0.CAUSE |= val & (0x3 << 8);
+                              RecalcIPCache();
+                              break;
+
+                           case CP0REG_SR:
+                              if((CP0.SR ^ val) & 0x10000)
+                                 PSX_DBG(PSX_DBG_SPARSE, "[CPU] IsC %u->%u\n", (bool)(CP0.SR & (1U << 16)), (bool)(val & (1U << 16)));
+
+                              CP0.SR = val & ~( (0x3 << 26) | (0x3 << 23) | (0x3 << 6));
+                              RecalcIPCache();
+                              break;
+                        }
                      }
-                  }
-                  DO_LDS();
-                  break;
+                     DO_LDS();
+                     break;
 
-               case (0x10 + 0x10):	// RFE
-                  // "Pop"
-                  DO_LDS();
-                  CP0.SR = (CP0.SR & ~0x0F) | ((CP0.SR >> 2) & 0x0F);
-                  RecalcIPCache();
-                  break;
-            }
+                  case (0x10 + 0x10):	// RFE
+                     // "Pop"
+                     DO_LDS();
+                     CP0.SR = (CP0.SR & ~0x0F) | ((CP0.SR >> 2) & 0x0F);
+                     RecalcIPCache();
+                     break;
+               }
             END_OPF;
 
             //
             // COP1
             //
             BEGIN_OPF(COP1, 0x11, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
-            END_OPF;
-
-            //
-            // COP2
-            //
-            BEGIN_OPF(COP2, 0x12, 0);
-            uint32_t sub_op = (instr >> 21) & 0x1F;
-
-            switch(sub_op)
-            {
-               default:
-                  DO_LDS();
-                  break;
-
-               case 0x00:		// MFC2	- Move from Coprocessor
-                  {
-                     uint32_t rt = (instr >> 16) & 0x1F;
-                     uint32_t rd = (instr >> 11) & 0x1F;
-
-                     DO_LDS();
-
-                     if(timestamp < gte_ts_done)
-                     {
-                        LDAbsorb = gte_ts_done - timestamp;
-                        timestamp = gte_ts_done;
-                     }
-                     else
-                        LDAbsorb = 0;
-
-                     LDWhich = rt;
-                     LDValue = GTE_ReadDR(rd);
-                  }
-                  break;
-
-               case 0x04:		// MTC2	- Move to Coprocessor
-                  {
-                     uint32_t rt = (instr >> 16) & 0x1F;
-                     uint32_t rd = (instr >> 11) & 0x1F;
-                     uint32_t val = GPR[rt];
-
-                     if(timestamp < gte_ts_done)
-                        timestamp = gte_ts_done;
-
-                     //printf("GTE WriteDR: %d %d\n", rd, val);
-                     GTE_WriteDR(rd, val);
-                     DO_LDS();
-                  }
-                  break;
-
-               case 0x02:		// CFC2
-                  {
-                     uint32_t rt = (instr >> 16) & 0x1F;
-                     uint32_t rd = (instr >> 11) & 0x1F;
-
-                     DO_LDS();
-
-                     if(timestamp < gte_ts_done)
-                     {
-                        LDAbsorb = gte_ts_done - timestamp;
-                        timestamp = gte_ts_done;
-                     }
-                     else
-                        LDAbsorb = 0;
-
-                     LDWhich = rt;
-                     LDValue = GTE_ReadCR(rd);
-
-                     //printf("GTE ReadCR: %d %d\n", rd, GPR[rt]);
-                  }		
-                  break;
-
-               case 0x06:		// CTC2
-                  {
-                     uint32_t rt = (instr >> 16) & 0x1F;
-                     uint32_t rd = (instr >> 11) & 0x1F;
-                     uint32_t val = GPR[rt];
-
-                     //printf("GTE WriteCR: %d %d\n", rd, val);
-
-                     if(timestamp < gte_ts_done)
-                        timestamp = gte_ts_done;
-
-                     GTE_WriteCR(rd, val);		 
-                     DO_LDS();
-                  }
-                  break;
-
-               case 0x10 ... 0x1F:
-                  //printf("%08x\n", PC);
-                  if(timestamp < gte_ts_done)
-                     timestamp = gte_ts_done;
-                  gte_ts_done = timestamp + GTE_Instruction(instr);
-                  DO_LDS();
-                  break;
-            }
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
             //
             // COP3
             //
             BEGIN_OPF(COP3, 0x13, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
             //
             // LWC0
             //
             BEGIN_OPF(LWC0, 0x30, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
             //
             // LWC1
             //
             BEGIN_OPF(LWC1, 0x31, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
-            END_OPF;
-
-            //
-            // LWC2
-            //
-            BEGIN_OPF(LWC2, 0x32, 0);
-            ITYPE;
-            uint32_t address = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(address & 3))
-            {
-               new_PC = Exception(EXCEPTION_ADEL, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-            {
-               if(timestamp < gte_ts_done)
-                  timestamp = gte_ts_done;
-
-               GTE_WriteDR(rt, ReadMemory<uint32>(timestamp, address, false, true));
-            }
-            // GTE stuff here
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
             //
             // LWC3
             //
             BEGIN_OPF(LWC3, 0x33, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
-
             //
             // SWC0
             //
             BEGIN_OPF(SWC0, 0x38, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
             //
             // SWC1
             //
             BEGIN_OPF(SWC1, 0x39, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_COPU, PC, new_PC_mask);
-            new_PC_mask = 0;
+               DO_LDS();
+               DO_EXCEPTION(EXCEPTION_COPU);
             END_OPF;
 
             //
-            // SWC2
-            //
-            BEGIN_OPF(SWC2, 0x3A, 0);
-            ITYPE;
-            uint32_t address = GPR[rs] + immediate;
-
-            if(MDFN_UNLIKELY(address & 0x3))
-            {
-               new_PC = Exception(EXCEPTION_ADES, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-            {
-               if(timestamp < gte_ts_done)
-                  timestamp = gte_ts_done;
-
-               WriteMemory<uint32>(timestamp, address, GTE_ReadDR(rt));
-            }
-            DO_LDS();
-            END_OPF;
-
-            //
-            // SWC3
-            ///
-            BEGIN_OPF(SWC3, 0x3B, 0);
-            DO_LDS();
-            new_PC = Exception(EXCEPTION_RI, PC, new_PC_mask);
-            new_PC_mask = 0;
-            END_OPF;
-
-
-            //
-            // DIV - Divide Word
-            //
-            BEGIN_OPF(DIV, 0, 0x1A);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               if(!GPR[rt])
-               {
-                  if(GPR[rs] & 0x80000000)
-                     LO = 1;
-                  else
-                     LO = 0xFFFFFFFF;
-
-                  HI = GPR[rs];
-               }
-               else if(GPR[rs] == 0x80000000 && GPR[rt] == 0xFFFFFFFF)
-               {
-                  LO = 0x80000000;
-                  HI = 0;
-               }
-               else
-               {
-                  LO = (int32)GPR[rs] / (int32)GPR[rt];
-                  HI = (int32)GPR[rs] % (int32)GPR[rt];
-               }
-            muldiv_ts_done = timestamp + 37;
-
-            DO_LDS();
-
-            END_OPF;
-
-
-            //
-            // DIVU - Divide Unsigned Word
-            //
-            BEGIN_OPF(DIVU, 0, 0x1B);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               if(!GPR[rt])
-               {
-                  LO = 0xFFFFFFFF;
-                  HI = GPR[rs];
-               }
-               else
-               {
-                  LO = GPR[rs] / GPR[rt];
-                  HI = GPR[rs] % GPR[rt];
-               }
-            muldiv_ts_done = timestamp + 37;
-
-            DO_LDS();
-            END_OPF;
-
-            //
-            // J - Jump
-            //
-            BEGIN_OPF(J, 0x02, 0);
-            JTYPE;
-
-            DO_LDS();
-
-            DO_BRANCH(target << 2, 0xF0000000);
-            END_OPF;
-
-            //
-            // JAL - Jump and Link
-            //
-            BEGIN_OPF(JAL, 0x03, 0);
-            JTYPE;
-
-            //GPR_DEPRES_BEGIN
-            GPR_RES(31);
-            //GPR_DEPRES_END
-
-            DO_LDS();
-
-            GPR[31] = PC + 8;
-
-            DO_BRANCH(target << 2, 0xF0000000);
-            END_OPF;
-
-            //
-            // JALR - Jump and Link Register
-            //
-            BEGIN_OPF(JALR, 0, 0x09);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t tmp = GPR[rs];
-
-            DO_LDS();
-
-            GPR[rd] = PC + 8;
-
-            DO_BRANCH(tmp, 0);
-
-            END_OPF;
-
-            //
-            // JR - Jump Register
-            //
-            BEGIN_OPF(JR, 0, 0x08);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t bt = GPR[rs];
-
-            DO_LDS();
-
-            DO_BRANCH(bt, 0);
-
-            END_OPF;
-
-            //
-            // LUI - Load Upper Immediate
-            //
-            BEGIN_OPF(LUI, 0x0F, 0);
-            ITYPE_ZE;		// Actually, probably would be sign-extending...if we were emulating a 64-bit MIPS chip :b
-
-            GPR_DEPRES_BEGIN
-               GPR_RES(rt);
-            GPR_DEPRES_END
-
-               DO_LDS();
-
-            GPR[rt] = immediate << 16;
-
-            END_OPF;
-
-            //
-            // MFHI - Move from HI
-            //
-            BEGIN_OPF(MFHI, 0, 0x10);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_RES(rd);
-            GPR_DEPRES_END
-
-               DO_LDS();
-
-            if(timestamp < muldiv_ts_done)
-            {
-               if(timestamp == muldiv_ts_done - 1)
-                  muldiv_ts_done--;
-               else
-               {
-                  do
-                  {
-                     if(ReadAbsorb[ReadAbsorbWhich])
-                        ReadAbsorb[ReadAbsorbWhich]--;
-                     timestamp++;
-                  } while(timestamp < muldiv_ts_done);
-               }
-            }
-
-            GPR[rd] = HI;
-
-            END_OPF;
-
-
-            //
-            // MFLO - Move from LO
-            //
-            BEGIN_OPF(MFLO, 0, 0x12);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_RES(rd);
-            GPR_DEPRES_END
-
-               DO_LDS();
-
-            if(timestamp < muldiv_ts_done)
-            {
-               if(timestamp == muldiv_ts_done - 1)
-                  muldiv_ts_done--;
-               else
-               {
-                  do
-                  {
-                     if(ReadAbsorb[ReadAbsorbWhich])
-                        ReadAbsorb[ReadAbsorbWhich]--;
-                     timestamp++;
-                  } while(timestamp < muldiv_ts_done);
-               }
-            }
-
-            GPR[rd] = LO;
-
-            END_OPF;
-
-
-            //
-            // MTHI - Move to HI
-            //
-            BEGIN_OPF(MTHI, 0, 0x11);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               HI = GPR[rs];
-
-            DO_LDS();
-
-            END_OPF;
-
-            //
-            // MTLO - Move to LO
-            //
-            BEGIN_OPF(MTLO, 0, 0x13);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               LO = GPR[rs];
-
-            DO_LDS();
-
-            END_OPF;
-
-
-            //
-            // MULT - Multiply Word
-            //
-            BEGIN_OPF(MULT, 0, 0x18);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint64 result;
-
-            result = (int64)(int32)GPR[rs] * (int32)GPR[rt];
-            muldiv_ts_done = timestamp + 7;
-
-            DO_LDS();
-
-            LO = result;
-            HI = result >> 32;
-
-            END_OPF;
-
-            //
-            // MULTU - Multiply Unsigned Word
-            //
-            BEGIN_OPF(MULTU, 0, 0x19);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint64 result;
-
-            result = (uint64)GPR[rs] * GPR[rt];
-            muldiv_ts_done = timestamp + 7;
-
-            DO_LDS();
-
-            LO = result;
-            HI = result >> 32;
-
-            END_OPF;
-
-
-            //
-            // NOR - NOR
-            //
-            BEGIN_OPF(NOR, 0, 0x27);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = ~(GPR[rs] | GPR[rt]);
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // OR - OR
-            //
-            BEGIN_OPF(OR, 0, 0x25);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] | GPR[rt];
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // ORI - OR Immediate
-            //
-            BEGIN_OPF(ORI, 0x0D, 0);
-            ITYPE_ZE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] | immediate;
-
-            DO_LDS();
-
-            GPR[rt] = result;
-
-            END_OPF;
-
-
-            //
-            // SLL - Shift Word Left Logical
-            //
-            BEGIN_OPF(SLL, 0, 0x00);	// SLL
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rt] << shamt;
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SLLV - Shift Word Left Logical Variable
-            //
-            BEGIN_OPF(SLLV, 0, 0x04);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rt] << (GPR[rs] & 0x1F);
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // SLT - Set on Less Than
-            //
-            BEGIN_OPF(SLT, 0, 0x2A);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = (bool)((int32)GPR[rs] < (int32)GPR[rt]);
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SLTI - Set on Less Than Immediate
-            //
-            BEGIN_OPF(SLTI, 0x0A, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = (bool)((int32)GPR[rs] < immediate);
-
-            DO_LDS();
-
-            GPR[rt] = result;
-
-            END_OPF;
-
-
-            //
-            // SLTIU - Set on Less Than Immediate, Unsigned
-            //
-            BEGIN_OPF(SLTIU, 0x0B, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = (bool)(GPR[rs] < (uint32)immediate);
-
-            DO_LDS();
-
-            GPR[rt] = result;
-
-            END_OPF;
-
-
-            //
-            // SLTU - Set on Less Than, Unsigned
-            //
-            BEGIN_OPF(SLTU, 0, 0x2B);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = (bool)(GPR[rs] < GPR[rt]);
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SRA - Shift Word Right Arithmetic
-            //
-            BEGIN_OPF(SRA, 0, 0x03);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = ((int32)GPR[rt]) >> shamt;
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SRAV - Shift Word Right Arithmetic Variable
-            //
-            BEGIN_OPF(SRAV, 0, 0x07);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = ((int32)GPR[rt]) >> (GPR[rs] & 0x1F);
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SRL - Shift Word Right Logical
-            //
-            BEGIN_OPF(SRL, 0, 0x02);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rt] >> shamt;
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // SRLV - Shift Word Right Logical Variable
-            //
-            BEGIN_OPF(SRLV, 0, 0x06);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rt] >> (GPR[rs] & 0x1F);
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SUB - Subtract Word
-            //
-            BEGIN_OPF(SUB, 0, 0x22);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] - GPR[rt];
-            bool ep = (((GPR[rs] ^ GPR[rt])) & (GPR[rs] ^ result)) & 0x80000000;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(ep))
-            {
-               new_PC = Exception(EXCEPTION_OV, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-               GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SUBU - Subtract Unsigned Word
-            //
-            BEGIN_OPF(SUBU, 0, 0x23); // SUBU
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] - GPR[rt];
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-
-            //
-            // SYSCALL
-            //
-            BEGIN_OPF(SYSCALL, 0, 0x0C);
-            DO_LDS();
-
-            new_PC = Exception(EXCEPTION_SYSCALL, PC, new_PC_mask);
-            new_PC_mask = 0;
-            END_OPF;
-
-
-            //
-            // XOR
-            //
-            BEGIN_OPF(XOR, 0, 0x26);
-            RTYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_RES(rd);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] ^ GPR[rt];
-
-            DO_LDS();
-
-            GPR[rd] = result;
-
-            END_OPF;
-
-            //
-            // XORI - Exclusive OR Immediate
-            //
-            BEGIN_OPF(XORI, 0x0E, 0);
-            ITYPE_ZE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_RES(rt);
-            GPR_DEPRES_END
-
-               uint32_t result = GPR[rs] ^ immediate;
-
-            DO_LDS();
-
-            GPR[rt] = result;
-            END_OPF;
-
-            //
-            // Memory access instructions(besides the coprocessor ones) follow:
-            //
-
-            //
-            // LB - Load Byte
-            //
-            BEGIN_OPF(LB, 0x20, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            LDWhich = rt;
-            LDValue = (int32)ReadMemory<int8>(timestamp, address);
-            END_OPF;
-
-            //
-            // LBU - Load Byte Unsigned
-            //
-            BEGIN_OPF(LBU, 0x24, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            LDWhich = rt;
-            LDValue = ReadMemory<uint8>(timestamp, address);
-            END_OPF;
-
-            //
-            // LH - Load Halfword
-            //
-            BEGIN_OPF(LH, 0x21, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(address & 1))
-            {
-               new_PC = Exception(EXCEPTION_ADEL, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-            {
-               LDWhich = rt;
-               LDValue = (int32)ReadMemory<int16>(timestamp, address);
-            }
-            END_OPF;
-
-            //
-            // LHU - Load Halfword Unsigned
-            //
-            BEGIN_OPF(LHU, 0x25, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(address & 1))
-            {
-               new_PC = Exception(EXCEPTION_ADEL, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-            {
-               LDWhich = rt;
-               LDValue = ReadMemory<uint16>(timestamp, address);
-            }
-            END_OPF;
-
-
-            //
-            // LW - Load Word
-            //
-            BEGIN_OPF(LW, 0x23, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            DO_LDS();
-
-            if(MDFN_UNLIKELY(address & 3))
-            {
-               new_PC = Exception(EXCEPTION_ADEL, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-            {
-               LDWhich = rt;
-               LDValue = ReadMemory<uint32>(timestamp, address);
-            }
-            END_OPF;
-
-            //
-            // SB - Store Byte
-            //
-            BEGIN_OPF(SB, 0x28, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            WriteMemory<uint8>(timestamp, address, GPR[rt]);
-
-            DO_LDS();
-            END_OPF;
-
-            // 
-            // SH - Store Halfword
-            //
-            BEGIN_OPF(SH, 0x29, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            if(MDFN_UNLIKELY(address & 0x1))
-            {
-               new_PC = Exception(EXCEPTION_ADES, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-               WriteMemory<uint16>(timestamp, address, GPR[rt]);
-
-            DO_LDS();
-            END_OPF;
-
-            // 
-            // SW - Store Word
-            //
-            BEGIN_OPF(SW, 0x2B, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            if(MDFN_UNLIKELY(address & 0x3))
-            {
-               new_PC = Exception(EXCEPTION_ADES, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
-            else
-               WriteMemory<uint32>(timestamp, address, GPR[rt]);
-
-            DO_LDS();
-            END_OPF;
-
-            // LWL and LWR load delay slot tomfoolery appears to apply even to MFC0! (and probably MFCn and CFCn as well, though they weren't explicitly tested)
-
-            //
-            // LWL - Load Word Left
-            //
-            BEGIN_OPF(LWL, 0x22, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            //GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-            uint32_t v = GPR[rt];
-
-            if(LDWhich == rt)
-            {
-               v = LDValue;
-               ReadFudge = 0;
-            }
-            else
-            {
+            // SWC3
+            ///
+            BEGIN_OPF(SWC3, 0x3B, 0);
                DO_LDS();
-            }
-
-            LDWhich = rt;
-            switch(address & 0x3)
-            {
-               case 0: LDValue = (v & ~(0xFF << 24)) | (ReadMemory<uint8>(timestamp, address & ~3) << 24);
-                       break;
-
-               case 1: LDValue = (v & ~(0xFFFF << 16)) | (ReadMemory<uint16>(timestamp, address & ~3) << 16);
-                       break;
-
-               case 2: LDValue = (v & ~(0xFFFFFF << 8)) | (ReadMemory<uint32>(timestamp, address & ~3, true) << 8);
-                       break;
-
-               case 3: LDValue = (v & ~(0xFFFFFFFF << 0)) | (ReadMemory<uint32>(timestamp, address & ~3) << 0);
-                       break;
-            }
-            END_OPF;
-
-            //
-            // SWL - Store Word Left
-            //
-            BEGIN_OPF(SWL, 0x2A, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            switch(address & 0x3)
-            {
-               case 0: WriteMemory<uint8>(timestamp, address & ~3, GPR[rt] >> 24);
-                       break;
-
-               case 1: WriteMemory<uint16>(timestamp, address & ~3, GPR[rt] >> 16);
-                       break;
-
-               case 2: WriteMemory<uint32>(timestamp, address & ~3, GPR[rt] >> 8, true);
-                       break;
-
-               case 3: WriteMemory<uint32>(timestamp, address & ~3, GPR[rt] >> 0);
-                       break;
-            }
-            DO_LDS();
-
+               DO_EXCEPTION(EXCEPTION_RI);
             END_OPF;
 
             //
-            // LWR - Load Word Right
+            // SYSCALL
             //
-            BEGIN_OPF(LWR, 0x26, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            //GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-            uint32_t v = GPR[rt];
-
-            if(LDWhich == rt)
-            {
-               v = LDValue;
-               ReadFudge = 0;
-            }
-            else
-            {
+            BEGIN_OPF(SYSCALL, 0, 0x0C);
                DO_LDS();
-            }
-
-            LDWhich = rt;
-            switch(address & 0x3)
-            {
-               case 0:
-                  LDValue = (v & ~(0xFFFFFFFF)) | ReadMemory<uint32>(timestamp, address);
-                  break;
-               case 1:
-                  LDValue = (v & ~(0xFFFFFF)) | ReadMemory<uint32>(timestamp, address, true);
-                  break;
-               case 2:
-                  LDValue = (v & ~(0xFFFF)) | ReadMemory<uint16>(timestamp, address);
-                  break;
-
-               case 3:
-                  LDValue = (v & ~(0xFF)) | ReadMemory<uint8>(timestamp, address);
-                  break;
-            }
-            END_OPF;
-
-            //
-            // SWR - Store Word Right
-            //
-            BEGIN_OPF(SWR, 0x2E, 0);
-            ITYPE;
-
-            GPR_DEPRES_BEGIN
-               GPR_DEP(rs);
-            GPR_DEP(rt);
-            GPR_DEPRES_END
-
-               uint32_t address = GPR[rs] + immediate;
-
-            switch(address & 0x3)
-            {
-               case 0:
-                  WriteMemory<uint32>(timestamp, address, GPR[rt]);
-                  break;
-
-               case 1:
-                  WriteMemory<uint32>(timestamp, address, GPR[rt], true);
-                  break;
-
-               case 2:
-                  WriteMemory<uint16>(timestamp, address, GPR[rt]);
-                  break;
-
-               case 3:
-                  WriteMemory<uint8>(timestamp, address, GPR[rt]);
-                  break;
-            }
-
-            DO_LDS();
 
+               DO_EXCEPTION(EXCEPTION_SYSCALL);
             END_OPF;
 
             //
             // Mednafen special instruction
             //
             BEGIN_OPF(INTERRUPT, 0x3F, 0);
-            if(Halted)
-            {
-               goto SkipNPCStuff;
-            }
-            else
-            {
-               DO_LDS();
+               if(Halted)
+               {
+                  goto SkipNPCStuff;
+               }
+               else
+               {
+                  DO_LDS();
 
-               new_PC = Exception(EXCEPTION_INT, PC, new_PC_mask);
-               new_PC_mask = 0;
-            }
+                  DO_EXCEPTION(EXCEPTION_INT);
+               }
             END_OPF;
+
+#include "cpu_ops.inc"
          }
 
 OpDone: ;
@@ -2248,6 +983,12 @@ SkipNPCStuff:	;
 
                //printf("\n");
       }
+
+      if(MDFN_UNLIKELY(Profiling))
+      {
+         PROF_Sample(PC, GPR[31], timestamp - prof_timestamp);
+         prof_timestamp = timestamp;
+      }
    } while(MDFN_LIKELY(PSX_EventHandler(timestamp)));
 
    if(gte_ts_done > 0)
@@ -2264,10 +1005,16 @@ SkipNPCStuff:	;
 pscpu_timestamp_t PS_CPU::Run(pscpu_timestamp_t timestamp_in, const bool ILHMode)
 {
    if(CPUHook || ADDBT)
-      return(RunReal<true, false>(timestamp_in));
+      return(RunReal<true, false, CORE_INTERPRETER>(timestamp_in));
    if (ILHMode)
-      return(RunReal<false, true>(timestamp_in));
-   return(RunReal<false, false>(timestamp_in));
+      return(RunReal<false, true, CORE_INTERPRETER>(timestamp_in));
+#ifdef PS_CPU_HAVE_JIT
+   if(CoreMode == CORE_DYNAREC)
+      return(RunReal<false, false, CORE_DYNAREC>(timestamp_in));
+#endif
+   if(CoreMode == CORE_CACHED_INTERPRETER)
+      return(RunReal<false, false, CORE_CACHED_INTERPRETER>(timestamp_in));
+   return(RunReal<false, false, CORE_INTERPRETER>(timestamp_in));
 }
 
 void PS_CPU::SetCPUHook(void (*cpuh)(const pscpu_timestamp_t timestamp, uint32_t pc), void (*addbt)(uint32_t from, uint32_t to, bool exception))
@@ -2570,4 +1317,316 @@ void PS_CPU::CheckBreakpoints(void (*callback)(bool write, uint32_t address, uns
 }
 
 
+//
+// Instructions that translated code(dynarec or cached interpreter) doesn't handle itself, run through the same bodies as
+// RunReal() but on the backed registers and JIT_timestamp.  opf_c is the instruction's opf if the caller already knows it,
+// or 0xFFFFFFFF to decode it here.  Returns non-zero if an exception was taken, in which case the PC has already been moved
+// to the exception handler.
+//
+#undef BEGIN_OPF
+#undef END_OPF
+#undef DO_BRANCH
+#undef DO_EXCEPTION
+
+#define BEGIN_OPF(name, arg_op, arg_funct) case MK_OPF(arg_op, arg_funct): {
+#define END_OPF } break;
+#define DO_BRANCH(offset, mask) { new_PC = (offset); new_PC_mask = (mask) & ~3; }
+#define DO_EXCEPTION(code) { new_PC = Exception((code), PC, new_PC_mask); exc = true; }
+
+template<unsigned opf_c>
+INLINE uint32_t PS_CPU::JIT_Op(uint32_t instr, uint32_t PC)
+{
+   pscpu_timestamp_t &timestamp = JIT_timestamp;
+   uint32_t &new_PC = BACKED_new_PC;
+   uint32_t &new_PC_mask = BACKED_new_PC_mask;
+   uint32_t &LDWhich = BACKED_LDWhich;
+   uint32_t &LDValue = BACKED_LDValue;
+   bool exc = false;
+   uint32_t opf = opf_c;
+
+   GPR[0] = 0;
+
+   if(opf_c == 0xFFFFFFFF)
+   {
+      opf = instr & 0x3F;
+
+      if(instr & (0x3F << 26))
+         opf = 0x40 | (instr >> 26);
+   }
+
+   switch(opf)
+   {
+      default:
+         assert(0);
+         break;
+
+#include "cpu_ops.inc"
+   }
+
+   if(exc)
+   {
+      BACKED_PC = new_PC;
+      new_PC = 4;
+      new_PC_mask = ~0U;
+      return(1);
+   }
+
+   return(0);
+}
+
+#undef BEGIN_OPF
+#undef END_OPF
+#undef DO_BRANCH
+#undef DO_EXCEPTION
+
+#define BEGIN_OPF(op, funct) case MK_OPF(op, funct): {
+#define END_OPF } break;
+
+uint32_t PS_CPU::JIT_OpThunk(PS_CPU *cpu, uint32_t instr, uint32_t PC)
+{
+   return cpu->JIT_Op<0xFFFFFFFF>(instr, PC);
+}
+
+// I-cache line fill for translated code, same as the one in RunReal().  Returns 0 if the I-cache is disabled, in which
+// case the instruction has to be left to the interpreter.
+uint32_t PS_CPU::JIT_ICacheMissThunk(PS_CPU *cpu, uint32_t PC)
+{
+   if(!(cpu->BIU & 0x800))
+      return(0);
+
+   __ICache *ICI = &cpu->ICache[((PC & 0xFF0) >> 2)];
+   const uint32_t *FMP = (uint32_t *)&cpu->FastMap[(PC &~ 0xF) >> FAST_MAP_SHIFT][PC &~ 0xF];
+
+   cpu->ReadAbsorb[cpu->ReadAbsorbWhich] = 0;
+   cpu->ReadAbsorbWhich = 0;
+
+   // | 0x2 to simulate (in)validity bits.
+   ICI[0x00].TV = (PC &~ 0xF) | 0x00 | 0x2;
+   ICI[0x01].TV = (PC &~ 0xF) | 0x04 | 0x2;
+   ICI[0x02].TV = (PC &~ 0xF) | 0x08 | 0x2;
+   ICI[0x03].TV = (PC &~ 0xF) | 0x0C | 0x2;
+
+   cpu->JIT_timestamp += 3;
+
+   switch(PC & 0xC)
+   {
+      case 0x0:
+         cpu->JIT_timestamp++;
+         ICI[0x00].TV &= ~0x2;
+         ICI[0x00].Data = LoadU32_LE(&FMP[0]);
+      case 0x4:
+         cpu->JIT_timestamp++;
+         ICI[0x01].TV &= ~0x2;
+         ICI[0x01].Data = LoadU32_LE(&FMP[1]);
+      case 0x8:
+         cpu->JIT_timestamp++;
+         ICI[0x02].TV &= ~0x2;
+         ICI[0x02].Data = LoadU32_LE(&FMP[2]);
+      case 0xC:
+         cpu->JIT_timestamp++;
+         ICI[0x03].TV &= ~0x2;
+         ICI[0x03].Data = LoadU32_LE(&FMP[3]);
+         break;
+   }
+
+   return(1);
+}
+
+//
+// Idle loop skipping for translated code.
+//
+// Games spend much of their time spinning on a RAM flag or an I/O status register until an interrupt or some hardware
+// state change happens, and all of those happen through the event system.  IdleLoop_Analyze() recognizes short loops that
+// branch back to their own start and do nothing besides ALU ops and loads; when one iteration of such a loop takes the CPU
+// from one state back to the exact same state without any event being handled or (re)scheduled in between, every further
+// iteration until the next event will be identical, so we add the time they would take in one go and leave off just short
+// of next_event_ts.  Skipping whole iterations keeps the result exactly the same as running them.
+//
+
+// Reads that have no side effects, and whose values don't change except by CPU writes or in event handlers.
+static INLINE bool IdleLoop_ReadOK(uint32_t address)
+{
+   address &= addr_mask[address >> 29];
+
+   if(address < 0x00800000)						// RAM
+      return(true);
+
+   if(address >= 0x1F800000 && address <= 0x1F8003FF)			// Scratchpad
+      return(true);
+
+   if(address >= 0x1F801070 && address <= 0x1F801077)			// IRQ status/mask
+      return(true);
+
+   if(address >= 0x1F801080 && address <= 0x1F8010FF)			// DMA
+      return(true);
+
+   if(address == 0x1F801800)						// CDC status
+      return(true);
+
+   if(address >= 0x1F801814 && address <= 0x1F801817)			// GPU status
+      return(true);
+
+   if(address >= 0x1FC00000 && address <= 0x1FC7FFFF)			// BIOS
+      return(true);
+
+   return(false);
+}
+
+// Returns the number of instructions(including the branch delay slot) of the idle loop starting at pc, or 0 if the code there
+// isn't one.  With check_reads, additionally requires that everything the loop reads, given the current register values,
+// is OK per IdleLoop_ReadOK().
+unsigned PS_CPU::IdleLoop_Analyze(uint32_t pc, bool check_reads)
+{
+   uint32_t written = 0;	// Registers written by the loop so far.
+   bool in_delay_slot = false;
+
+   if(check_reads && BACKED_LDWhich != 0x20)
+      return(0);
+
+   for(unsigned count = 0; count < IDLE_LOOP_MAX_INSTRUCTIONS; count++)
+   {
+      const uint32_t addr = pc + count * 4;
+      const unsigned ici = (addr & 0xFFC) >> 2;
+      uint32_t instr;
+      unsigned rs, rt, rd;
+
+      if(ICache[ici].TV == addr)
+         instr = ICache[ici].Data;
+      else
+         instr = LoadU32_LE((uint32_t *)&FastMap[addr >> FAST_MAP_SHIFT][addr]);
+
+      rs = (instr >> 21) & 0x1F;
+      rt = (instr >> 16) & 0x1F;
+      rd = (instr >> 11) & 0x1F;
+
+      switch(instr >> 26)
+      {
+         default:
+            return(0);
+
+         case 0x00:
+            switch(instr & 0x3F)
+            {
+               default:
+                  return(0);
+
+               case 0x00: case 0x02: case 0x03:	// SLL, SRL, SRA
+               case 0x04: case 0x06: case 0x07:	// SLLV, SRLV, SRAV
+               case 0x21: case 0x23:			// ADDU, SUBU
+               case 0x24: case 0x25: case 0x26: case 0x27:	// AND, OR, XOR, NOR
+               case 0x2A: case 0x2B:			// SLT, SLTU
+                  written |= 1U << rd;
+                  break;
+            }
+            break;
+
+         case 0x09: case 0x0A: case 0x0B:	// ADDIU, SLTI, SLTIU
+         case 0x0C: case 0x0D: case 0x0E:	// ANDI, ORI, XORI
+         case 0x0F:				// LUI
+            written |= 1U << rt;
+            break;
+
+         case 0x20: case 0x21: case 0x23:	// LB, LH, LW
+         case 0x24: case 0x25:			// LBU, LHU
+            if(check_reads)
+            {
+               static const uint8_t size_mask[8] = { 0, 1, 0, 3, 0, 1, 0, 0 };
+               const uint32_t address = GPR[rs] + (int16)(instr & 0xFFFF);
+
+               if(written & (1U << rs))
+                  return(0);
+
+               if((address & size_mask[(instr >> 26) & 0x7]) || !IdleLoop_ReadOK(address))
+                  return(0);
+            }
+            written |= 1U << rt;
+            break;
+
+         case 0x01:	// BCOND
+         case 0x02:	// J
+         case 0x04: case 0x05: case 0x06: case 0x07:	// BEQ, BNE, BLEZ, BGTZ
+         {
+            uint32_t target;
+
+            if(in_delay_slot)
+               return(0);
+
+            if((instr >> 26) == 0x01 && (rt & 0x1E) == 0x10)	// BLTZAL, BGEZAL
+               return(0);
+
+            if((instr >> 26) == 0x02)
+               target = ((addr + 4) & 0xF0000000) | ((instr & 0x03FFFFFF) << 2);
+            else
+               target = addr + 4 + ((uint32_t)(int16)(instr & 0xFFFF) << 2);
+
+            if(target != pc)
+               return(0);
+
+            in_delay_slot = true;
+            continue;
+         }
+      }
+
+      if(in_delay_slot)
+         return(count + 1);
+   }
+
+   return(0);
+}
+
+// Called before running an idle loop block that's len instructions long.
+void PS_CPU::IdleLoop_Begin(uint32_t pc, unsigned len)
+{
+   // An iteration that fills I-cache lines takes longer than the ones after it.
+   for(unsigned i = 0; i < len; i++)
+   {
+      if(ICache[((pc + i * 4) & 0xFFC) >> 2].TV != pc + i * 4)
+      {
+         IdleLoop.EventSerial = EventSerial - 1;
+         return;
+      }
+   }
+
+   memcpy(IdleLoop.GPR, GPR, sizeof(IdleLoop.GPR));
+   IdleLoop.LDWhich = BACKED_LDWhich;
+   IdleLoop.LDValue = BACKED_LDValue;
+   IdleLoop.LDAbsorb = LDAbsorb;
+   memcpy(IdleLoop.ReadAbsorb, ReadAbsorb, sizeof(IdleLoop.ReadAbsorb));
+   IdleLoop.ReadAbsorbWhich = ReadAbsorbWhich;
+   IdleLoop.ReadFudge = ReadFudge;
+   IdleLoop.EventSerial = EventSerial;
+   IdleLoop.timestamp = JIT_timestamp;
+}
+
+// Called after an idle loop block begun with IdleLoop_Begin() has run one full iteration and branched back to pc.
+void PS_CPU::IdleLoop_End(uint32_t pc)
+{
+   pscpu_timestamp_t period;
+   int32 iterations;
+
+   if(IdleLoop.EventSerial != EventSerial)
+      return;
+
+   if(memcmp(IdleLoop.GPR, GPR, sizeof(IdleLoop.GPR)) || IdleLoop.LDWhich != BACKED_LDWhich || IdleLoop.LDValue != BACKED_LDValue ||
+	IdleLoop.LDAbsorb != LDAbsorb || memcmp(IdleLoop.ReadAbsorb, ReadAbsorb, sizeof(IdleLoop.ReadAbsorb)) ||
+	IdleLoop.ReadAbsorbWhich != ReadAbsorbWhich || IdleLoop.ReadFudge != ReadFudge)
+   {
+      return;
+   }
+
+   period = JIT_timestamp - IdleLoop.timestamp;
+
+   if(period <= 0 || JIT_timestamp >= next_event_ts)
+      return;
+
+   if(!IdleLoop_Analyze(pc, true))
+      return;
+
+   iterations = (next_event_ts - 1 - JIT_timestamp) / period;
+   JIT_timestamp += iterations * period;
+}
+
+#include "cpu_cached.inc"
+#include "cpu_hle.inc"
+
 }
@@ -45,6 +45,12 @@ namespace MDFN_IEN_PSX
 
 #define PS_CPU_EMULATE_ICACHE 1
 
+#if defined(__x86_64__) || defined(_M_X64)
+ #define PS_CPU_HAVE_JIT 1
+#endif
+
+class PS_CPU_JIT;
+
 class PS_CPU
 {
  public:
@@ -62,10 +68,28 @@ class PS_CPU
  INLINE void SetEventNT(const pscpu_timestamp_t next_event_ts_arg)
  {
   next_event_ts = next_event_ts_arg;
+  EventSerial++;
  }
 
  pscpu_timestamp_t Run(pscpu_timestamp_t timestamp_in, const bool ILHMode);
 
+ enum
+ {
+  CORE_INTERPRETER = 0,
+  CORE_CACHED_INTERPRETER,
+  CORE_DYNAREC
+ };
+
+ // Selects the CPU core used by Run() outside of debug and ILH mode; falls back to the interpreter if the requested core
+ // isn't available on this host.
+ void SetCoreMode(unsigned mode) MDFN_COLD;
+
+ // Enables running some BIOS calls natively instead of through the BIOS code; see cpu_hle.inc
+ void SetBIOSHLE(bool enabled) MDFN_COLD;
+
+ // Enables sampling of the guest PC for the profiler; see profiler.h
+ void SetProfiling(bool enabled) MDFN_COLD;
+
  void Power(void);
 
  // which ranges 0-5, inclusive
@@ -120,6 +144,12 @@ class PS_CPU
   uint32 ICache_Bulk[2048];
  };
 
+ // Address of the next word in the I-cache line last fetched from by the interpreter, if it's known to be a hit.
+ // A valid word implies valid words after it in the same line(line fills always run to the end of the line), so
+ // straight-line code only needs to check the tags at line boundaries.  Reset to ~0U by anything that changes
+ // tags behind the interpreter's back(BIU writes, tag test mode writes, the other cores, state loads).
+ uint32_t ICache_NextPC;
+
  enum
  {
   CP0REG_BPC = 3,		// PC breakpoint address.
@@ -198,6 +228,92 @@ class PS_CPU
  uint8_t *FastMap[1 << (32 - FAST_MAP_SHIFT)];
  uint8_t DummyPage[FAST_MAP_PSIZE];
 
+ unsigned CoreMode;
+
+ //
+ // Dynarec stuff; see cpu_jit.h
+ //
+ friend class PS_CPU_JIT;
+ PS_CPU_JIT *JIT;
+ pscpu_timestamp_t JIT_timestamp;	// Timestamp while running translated code(dynarec or cached interpreter).
+
+ template<unsigned opf_c> uint32_t JIT_Op(uint32_t instr, uint32_t PC);
+ static uint32_t JIT_OpThunk(PS_CPU *cpu, uint32_t instr, uint32_t PC);
+ static uint32_t JIT_ICacheMissThunk(PS_CPU *cpu, uint32_t PC);
+
+ //
+ // Cached interpreter stuff; see cpu_cached.inc
+ //
+ struct CI_Op;
+ typedef uint32_t (*CI_Handler)(PS_CPU *cpu, const CI_Op *op, uint32_t PC);
+
+ struct CI_Op
+ {
+  CI_Handler handler;	// NULL ends the block.
+  uint32_t instr;	// What the op was decoded from; checked against the I-cache before each run.
+  uint8_t delay_slot;
+ };
+
+ struct CI_BlockEntry
+ {
+  CI_Op *ops;
+  uint32_t pc;
+  uint32_t idle_len;	// See IdleLoop_Analyze()
+ };
+
+ enum { CI_BLOCK_MAX_INSTRUCTIONS = 64 };
+ enum { CI_POOL_SIZE = 256 * 1024 };	// In CI_Ops.
+
+ CI_BlockEntry *CI_Blocks;	// [2048 * 1024 / 4]
+ CI_Op *CI_Pool;
+ uint32_t CI_PoolUsed;
+
+ bool CI_Init(void) MDFN_COLD;
+ void CI_Kill(void) MDFN_COLD;
+ void CI_Flush(void);
+ CI_Op *CI_Decode(uint32_t pc);
+ bool CI_Execute(void);
+ template<unsigned opf> static uint32_t CI_Thunk(PS_CPU *cpu, const CI_Op *op, uint32_t PC);
+
+ //
+ // BIOS HLE stuff; see cpu_hle.inc
+ //
+ bool HLE_Enabled;
+
+ uint8_t *HLE_RAMPtr(uint32_t A, uint32_t len);
+ uint8_t *HLE_StrPtr(uint32_t A, uint32_t *len);
+ uint8_t *HLE_EvCBPtr(uint32_t ev);
+ bool HLE_StrCmp(uint32_t A, uint32_t B, uint32_t n, int32_t *result, uint32_t *scanned);
+ bool HLE_Call(uint32_t PC, pscpu_timestamp_t &timestamp);
+ bool HLE_CallA0(uint32_t fn, uint32_t *cycles);
+ bool HLE_CallB0(uint32_t fn, uint32_t *cycles);
+
+ bool Profiling;
+
+ //
+ // Idle loop skipping for translated code; see IdleLoop_Analyze() in cpu.cpp
+ //
+ enum { IDLE_LOOP_MAX_INSTRUCTIONS = 16 };
+
+ uint32_t EventSerial;	// Bumped by SetEventNT(), so we can tell if any event was handled or (re)scheduled.
+
+ struct
+ {
+  uint32_t GPR[32];
+  uint32_t LDWhich;
+  uint32_t LDValue;
+  uint32_t LDAbsorb;
+  uint8_t ReadAbsorb[0x20 + 1];
+  uint8_t ReadAbsorbWhich;
+  uint8_t ReadFudge;
+  uint32_t EventSerial;
+  pscpu_timestamp_t timestamp;
+ } IdleLoop;
+
+ unsigned IdleLoop_Analyze(uint32_t pc, bool check_reads);
+ void IdleLoop_Begin(uint32_t pc, unsigned len);
+ void IdleLoop_End(uint32_t pc);
+
  enum
  {
   EXCEPTION_INT = 0,
@@ -217,7 +333,7 @@ class PS_CPU
 
  uint32_t Exception(uint32_t code, uint32_t PC, const uint32_t NPM) MDFN_WARN_UNUSED_RESULT;
 
- template<bool DebugMode, bool ILHMode> pscpu_timestamp_t RunReal(pscpu_timestamp_t timestamp_in);
+ template<bool DebugMode, bool ILHMode, unsigned XlatMode> pscpu_timestamp_t RunReal(pscpu_timestamp_t timestamp_in);
 
  template<typename T> T PeekMemory(uint32_t address) MDFN_COLD;
  template<typename T> T ReadMemory(pscpu_timestamp_t &timestamp, uint32_t address, bool DS24 = false, bool LWC_timing = false);
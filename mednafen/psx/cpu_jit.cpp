@@ -0,0 +1,966 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "psx.h"
+#include "cpu.h"
+#include "cpu_jit.h"
+
+#ifdef PS_CPU_HAVE_JIT
+
+#ifdef _WIN32
+ #include <windows.h>
+#else
+ #include <sys/mman.h>
+ #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+  #define MAP_ANONYMOUS MAP_ANON
+ #endif
+#endif
+
+/*
+ Register usage in translated code:
+	rbx	PS_CPU *, all R3000A state is addressed as [rbx + disp32]
+	ebp	JIT_timestamp; written back around helper calls and on exit
+	r12	base of main RAM
+	eax, ecx, edx	scratch; edx holds an instruction's result across DO_LDS emulation, which only touches eax and ecx.
+
+ The MIPS GPRs stay in memory, so there's nothing to spill around helper calls or on block exit.
+*/
+
+namespace MDFN_IEN_PSX
+{
+
+const unsigned *PSX_GetDMASuckSuckPtr(void);
+
+enum
+{
+ X_EAX = 0,
+ X_ECX = 1,
+ X_EDX = 2,
+ X_EBX = 3,
+ X_ESP = 4,
+ X_EBP = 5,
+ X_ESI = 6,
+ X_EDI = 7,
+ X_R8 = 8,
+};
+
+#ifdef _WIN32
+static const unsigned ArgRegs[3] = { X_ECX, X_EDX, X_R8 };
+#else
+static const unsigned ArgRegs[3] = { X_EDI, X_ESI, X_EDX };
+#endif
+
+enum
+{
+ CC_B = 0x2,
+ CC_AE = 0x3,
+ CC_E = 0x4,
+ CC_NE = 0x5,
+ CC_S = 0x8,
+ CC_L = 0xC,
+ CC_GE = 0xD,
+ CC_LE = 0xE,
+ CC_G = 0xF
+};
+
+// Group 1 ALU ops; "op r32, r/m32" opcode is (ext << 3) | 0x03
+enum
+{
+ ALU_ADD = 0,
+ ALU_OR = 1,
+ ALU_AND = 4,
+ ALU_SUB = 5,
+ ALU_XOR = 6,
+ ALU_CMP = 7
+};
+
+class X64Emitter
+{
+ public:
+
+ X64Emitter(uint8 *p, int32 ts_offs_arg, const uint8 *ram_arg) : pos(p), ts_offs(ts_offs_arg), ram(ram_arg) { }
+
+ uint8 *pos;
+ const int32 ts_offs;
+ const uint8 *ram;
+
+ // mov/movzx/movsx ecx, [r12 + rdx]
+ INLINE void ram_load(unsigned size, bool sign)
+ {
+  u8(0x41);
+  if(size == 4)
+   u8(0x8B);
+  else
+  {
+   u8(0x0F);
+   u8((size == 1) ? (sign ? 0xBE : 0xB6) : (sign ? 0xBF : 0xB7));
+  }
+  u8(0x0C); u8(0x14);
+ }
+
+ // mov [r12 + rdx], ecx/cx/cl
+ INLINE void ram_store(unsigned size)
+ {
+  if(size == 2)
+   u8(0x66);
+  u8(0x41);
+  u8((size == 1) ? 0x88 : 0x89);
+  u8(0x0C); u8(0x14);
+ }
+
+ INLINE void u8(uint8 v) { *pos++ = v; }
+ INLINE void u32(uint32 v) { memcpy(pos, &v, 4); pos += 4; }
+ INLINE void u64(uint64 v) { memcpy(pos, &v, 8); pos += 8; }
+
+ // ModRM for [rbx + disp32]
+ INLINE void mem(unsigned reg, int32 disp) { u8(0x80 | ((reg & 7) << 3) | X_EBX); u32(disp); }
+
+ // ModRM + SIB for [rbx + rax * (1 << scale) + disp32]
+ INLINE void mem_rax(unsigned reg, unsigned scale, int32 disp) { u8(0x84 | ((reg & 7) << 3)); u8((scale << 6) | (X_EAX << 3) | X_EBX); u32(disp); }
+
+ INLINE void load(unsigned reg, int32 disp) { u8(0x8B); mem(reg, disp); }
+ INLINE void store(int32 disp, unsigned reg) { u8(0x89); mem(reg, disp); }
+ INLINE void store_imm(int32 disp, uint32 imm) { u8(0xC7); mem(0, disp); u32(imm); }
+ INLINE void store8(int32 disp, unsigned reg) { u8(0x88); mem(reg, disp); }	// al, cl, dl, bl only
+ INLINE void store8_imm(int32 disp, uint8 imm) { u8(0xC6); mem(0, disp); u8(imm); }
+ INLINE void load8zx(unsigned reg, int32 disp) { u8(0x0F); u8(0xB6); mem(reg, disp); }
+ INLINE void mov_imm(unsigned reg, uint32 imm) { if(reg & 8) u8(0x41); u8(0xB8 + (reg & 7)); u32(imm); }
+
+ INLINE void alu(unsigned op, unsigned reg, int32 disp) { u8((op << 3) | 0x03); mem(reg, disp); }
+ INLINE void alu_imm(unsigned op, unsigned reg, uint32 imm) { u8(0x81); u8(0xC0 | (op << 3) | reg); u32(imm); }
+ INLINE void alu_mem_imm(unsigned op, int32 disp, uint32 imm) { u8(0x81); mem(op, disp); u32(imm); }
+ INLINE void alu8_mem_imm(unsigned op, int32 disp, uint8 imm) { u8(0x80); mem(op, disp); u8(imm); }
+
+ INLINE void xor_self(unsigned reg) { u8(0x31); u8(0xC0 | (reg << 3) | reg); }
+ INLINE void setcc_dl(unsigned cc) { u8(0x0F); u8(0x90 | cc); u8(0xC2); }
+ INLINE void not_edx(void) { u8(0xF7); u8(0xD2); }
+ INLINE void test_dl(void) { u8(0x84); u8(0xD2); }
+ INLINE void test_eax(void) { u8(0x85); u8(0xC0); }
+
+ // ext: 4 = shl, 5 = shr, 7 = sar
+ INLINE void shift_edx_imm(unsigned ext, uint8 count) { u8(0xC1); u8(0xC0 | (ext << 3) | X_EDX); u8(count); }
+ INLINE void shift_edx_cl(unsigned ext) { u8(0xD3); u8(0xC0 | (ext << 3) | X_EDX); }
+
+ // Returns the position of the rel32 to patch.
+ INLINE uint8 *jcc(unsigned cc) { u8(0x0F); u8(0x80 | cc); u32(0); return pos - 4; }
+ INLINE uint8 *jmp(void) { u8(0xE9); u32(0); return pos - 4; }
+
+ static INLINE void patch(uint8 *rel, const uint8 *target)
+ {
+  int32 d = (int32)(target - (rel + 4));
+  memcpy(rel, &d, 4);
+ }
+
+ INLINE void mov_rbx_arg0(void) { u8(0x48); u8(0x89); u8(0xC0 | (ArgRegs[0] << 3) | X_EBX); }
+ INLINE void mov_arg0_rbx(void) { u8(0x48); u8(0x89); u8(0xC0 | (X_EBX << 3) | ArgRegs[0]); }
+
+ INLINE void call(const void *func)
+ {
+  u8(0x48); u8(0xB8); u64((uint64)(uintptr_t)func);	// mov rax, imm64
+  u8(0xFF); u8(0xD0);					// call rax
+ }
+
+ // Calls a helper; the timestamp is written back before and reloaded after, without touching the helper's return value.
+ INLINE void call_helper(const void *func)
+ {
+  store(ts_offs, X_EBP);
+  call(func);
+  load(X_EBP, ts_offs);
+ }
+
+ INLINE void prologue(void)
+ {
+  u8(0x53);				// push rbx
+  u8(0x55);				// push rbp
+  u8(0x41); u8(0x54);			// push r12
+  u8(0x48); u8(0x83); u8(0xEC); u8(0x20);	// sub rsp, 32 (shadow space on Win64, keeps rsp 16-byte aligned everywhere)
+  mov_rbx_arg0();
+  load(X_EBP, ts_offs);
+  u8(0x49); u8(0xBC); u64((uint64)(uintptr_t)ram);	// mov r12, imm64
+ }
+
+ INLINE void epilogue(void)
+ {
+  store(ts_offs, X_EBP);
+  u8(0x48); u8(0x83); u8(0xC4); u8(0x20);	// add rsp, 32
+  u8(0x41); u8(0x5C);			// pop r12
+  u8(0x5D);				// pop rbp
+  u8(0x5B);				// pop rbx
+  u8(0xC3);				// ret
+ }
+};
+
+PS_CPU_JIT::PS_CPU_JIT(PS_CPU *cpu_arg) : cpu(cpu_arg), Blocks(NULL), CodeBase(NULL), CodePos(NULL)
+{
+
+}
+
+PS_CPU_JIT::~PS_CPU_JIT()
+{
+ if(CodeBase)
+ {
+#ifdef _WIN32
+  VirtualFree(CodeBase, 0, MEM_RELEASE);
+#else
+  munmap(CodeBase, CODE_CACHE_SIZE);
+#endif
+  CodeBase = NULL;
+ }
+
+ if(Blocks)
+ {
+  free(Blocks);
+  Blocks = NULL;
+ }
+}
+
+bool PS_CPU_JIT::Init(void)
+{
+#ifdef _WIN32
+ CodeBase = (uint8 *)VirtualAlloc(NULL, CODE_CACHE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+ CodeBase = (uint8 *)mmap(NULL, CODE_CACHE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+ if(CodeBase == (uint8 *)MAP_FAILED)
+  CodeBase = NULL;
+#endif
+
+ if(!CodeBase)
+  return(false);
+
+ if(!(Blocks = (BlockEntry *)calloc(2048 * 1024 / 4, sizeof(BlockEntry))))
+  return(false);
+
+ CodePos = CodeBase;
+
+ return(true);
+}
+
+void PS_CPU_JIT::Flush(void)
+{
+ memset(Blocks, 0, (2048 * 1024 / 4) * sizeof(BlockEntry));
+ CodePos = CodeBase;
+}
+
+bool PS_CPU_JIT::Execute(void)
+{
+ const uint32 pc = cpu->BACKED_PC;
+ BlockEntry *be;
+ unsigned idle_len;
+ uint32 ret;
+
+ if(!PCCanTranslate(pc))
+  return(false);
+
+ be = &Blocks[PCToIndex(pc)];
+
+ if(MDFN_UNLIKELY(!be->func || be->pc != pc))
+ {
+  be->func = Compile(pc);
+  be->pc = pc;
+  be->idle_len = cpu->IdleLoop_Analyze(pc, false);
+ }
+
+ idle_len = be->idle_len;
+
+ if(MDFN_UNLIKELY(idle_len))
+  cpu->IdleLoop_Begin(pc, idle_len);
+
+ ret = be->func(cpu);
+
+ if(MDFN_UNLIKELY(idle_len) && ret == BLOCK_RET_OK && cpu->BACKED_PC == pc)
+  cpu->IdleLoop_End(pc);
+
+ switch(ret)
+ {
+  case BLOCK_RET_OK:
+	return(true);
+
+  case BLOCK_RET_STALE:
+	be->func = NULL;
+	return(true);
+
+  case BLOCK_RET_STALE_ENTRY:
+	// The I-cache holds something other than what we translated; translate what's there now and try again.
+	be->func = Compile(pc);
+	be->pc = pc;
+	be->idle_len = cpu->IdleLoop_Analyze(pc, false);
+
+	switch(be->func(cpu))
+	{
+	 case BLOCK_RET_OK:
+		return(true);
+
+	 case BLOCK_RET_STALE:
+		be->func = NULL;
+		return(true);
+
+	 case BLOCK_RET_INTERPRET:
+		// The first run may have filled the line; have the top of the interpreter loop come back here with its
+		// time accounted for.
+		return(true);
+	}
+	break;
+ }
+
+ return(false);
+}
+
+enum
+{
+ KIND_STOP = 0,
+ KIND_ALU,
+ KIND_BRANCH,
+ KIND_HELPER,		// Handled by PS_CPU::JIT_Op(), doesn't leave a load pending.
+ KIND_HELPER_LOAD,	// Handled by PS_CPU::JIT_Op(), leaves a load of rt pending.
+ KIND_LOAD,		// LB LBU LH LHU LW; inline for main RAM, PS_CPU::JIT_Op() otherwise.
+ KIND_STORE,		// SB SH SW; inline for main RAM, PS_CPU::JIT_Op() otherwise.
+};
+
+static unsigned Classify(uint32 instr)
+{
+ const unsigned op = instr >> 26;
+
+ if(!op)
+ {
+  switch(instr & 0x3F)
+  {
+   case 0x00: case 0x02: case 0x03: case 0x04: case 0x06: case 0x07:	// SLL SRL SRA SLLV SRLV SRAV
+   case 0x21: case 0x23: case 0x24: case 0x25: case 0x26: case 0x27:	// ADDU SUBU AND OR XOR NOR
+   case 0x2A: case 0x2B:						// SLT SLTU
+	return KIND_ALU;
+
+   case 0x08: case 0x09:	// JR JALR
+	return KIND_BRANCH;
+
+   case 0x10: case 0x11: case 0x12: case 0x13:	// MFHI MTHI MFLO MTLO
+   case 0x18: case 0x19: case 0x1A: case 0x1B:	// MULT MULTU DIV DIVU
+   case 0x20: case 0x22:			// ADD SUB
+	return KIND_HELPER;
+  }
+
+  return KIND_STOP;
+ }
+
+ switch(op)
+ {
+  case 0x01: case 0x02: case 0x03: case 0x04: case 0x05: case 0x06: case 0x07:	// BCOND J JAL BEQ BNE BLEZ BGTZ
+	return KIND_BRANCH;
+
+  case 0x09: case 0x0A: case 0x0B: case 0x0C: case 0x0D: case 0x0E: case 0x0F:	// ADDIU SLTI SLTIU ANDI ORI XORI LUI
+	return KIND_ALU;
+
+  case 0x08:	// ADDI
+  case 0x2A: case 0x2E:	// SWL SWR
+  case 0x32: case 0x3A:	// LWC2 SWC2
+	return KIND_HELPER;
+
+  case 0x22: case 0x26:	// LWL LWR
+	return KIND_HELPER_LOAD;
+
+  case 0x20: case 0x21: case 0x23: case 0x24: case 0x25:	// LB LH LW LBU LHU
+	return KIND_LOAD;
+
+  case 0x28: case 0x29: case 0x2B:	// SB SH SW
+	return KIND_STORE;
+
+  case 0x12:	// COP2
+	{
+	 const unsigned sub_op = (instr >> 21) & 0x1F;
+
+	 if(sub_op == 0x00 || sub_op == 0x02)	// MFC2 CFC2
+	  return KIND_HELPER_LOAD;
+
+	 return KIND_HELPER;
+	}
+ }
+
+ return KIND_STOP;
+}
+
+PS_CPU_JIT::BlockFunc PS_CPU_JIT::Compile(uint32 pc0)
+{
+ #define CPU_OFFS(m) ((int32)((uint8 *)&(cpu->m) - (uint8 *)cpu))
+ const int32 o_GPR = CPU_OFFS(GPR[0]);
+ const int32 o_PC = CPU_OFFS(BACKED_PC);
+ const int32 o_NPC = CPU_OFFS(BACKED_new_PC);
+ const int32 o_NPCM = CPU_OFFS(BACKED_new_PC_mask);
+ const int32 o_LDWhich = CPU_OFFS(BACKED_LDWhich);
+ const int32 o_LDValue = CPU_OFFS(BACKED_LDValue);
+ const int32 o_LDAbsorb = CPU_OFFS(LDAbsorb);
+ const int32 o_IPCache = CPU_OFFS(IPCache);
+ const int32 o_NextTS = CPU_OFFS(next_event_ts);
+ const int32 o_TS = CPU_OFFS(JIT_timestamp);
+ const int32 o_ICache = CPU_OFFS(ICache[0]);
+ const int32 o_RA = CPU_OFFS(ReadAbsorb[0]);
+ const int32 o_RADummy = CPU_OFFS(ReadAbsorbDummy);
+ const int32 o_RAWhich = CPU_OFFS(ReadAbsorbWhich);
+ const int32 o_ReadFudge = CPU_OFFS(ReadFudge);
+ const int32 o_SR = CPU_OFFS(CP0.SR);
+ #undef CPU_OFFS
+
+ struct Exit
+ {
+  uint8 *rel;
+  uint32 pc;	// ~0U to leave BACKED_PC alone
+  uint32 ret;
+ };
+ Exit exits[(BLOCK_MAX_INSTRUCTIONS + 1) * 5];	// At most 5 per instruction, +1 for the delay slot.
+ unsigned num_exits = 0;
+
+ struct Miss
+ {
+  uint8 *rel;
+  uint8 *resume;
+  uint32 pc;
+ };
+ Miss misses[BLOCK_MAX_INSTRUCTIONS + 1];
+ unsigned num_misses = 0;
+
+ struct Slow
+ {
+  uint8 *rel[3];
+  uint8 *resume;
+  uint32 instr;
+  uint32 pc;
+  bool zero_r0;
+  bool check_ipc;
+ };
+ Slow slows[BLOCK_MAX_INSTRUCTIONS + 1];
+ unsigned num_slows = 0;
+
+ struct Absorb
+ {
+  uint8 *rel;
+  uint8 *resume;
+ };
+ Absorb absorbs[BLOCK_MAX_INSTRUCTIONS + 1];
+ unsigned num_absorbs = 0;
+
+ if((size_t)(CodePos - CodeBase) > CODE_CACHE_SIZE - CODE_CACHE_BLOCK_SLACK)
+  Flush();
+
+ uint8 *const code = CodePos;
+ X64Emitter e(code, o_TS, cpu->FastMap[0]);
+
+ //
+ // Compile-time knowledge of the load delay state; -1 means unknown(runtime LDWhich).
+ //
+ int ld = -1;
+ bool fudge_none = false;	// ReadFudge is known to be 0x20
+ bool dummy_synced = false;	// ReadAbsorbDummy is known to match LDAbsorb
+
+ // I-cache miss, handled out of line; falls back to the interpreter if the I-cache is disabled.
+ #define EMIT_MISS(pc_) { misses[num_misses].rel = e.jcc(CC_NE); misses[num_misses].resume = e.pos; misses[num_misses].pc = (pc_); num_misses++; }
+ #define EXIT(cc_, pc_, ret_) { exits[num_exits].rel = e.jcc(cc_); exits[num_exits].pc = (pc_); exits[num_exits].ret = (ret_); num_exits++; }
+
+ //
+ // Calls JIT_Op() for one instruction.  Its DO_LDS may land a load in r0 if one was pending, and memory accesses can
+ // assert an IRQ or halt the CPU for DMA; the interpreter deals with those(except in a delay slot, where the block
+ // ends right after anyway).
+ //
+ #define EMIT_HELPER(instr_, pc_, zero_r0_, check_ipc_) {			\
+	 e.mov_arg0_rbx();								\
+	 e.mov_imm(ArgRegs[1], (instr_));						\
+	 e.mov_imm(ArgRegs[2], (pc_));							\
+	 e.call_helper((const void *)&PS_CPU::JIT_OpThunk);				\
+	 e.test_eax();									\
+	 EXIT(CC_NE, ~0U, BLOCK_RET_OK);	/* Exception; PC is already at the handler. */	\
+	 if(zero_r0_)									\
+	  e.store_imm(o_GPR, 0);							\
+	 if(check_ipc_)									\
+	 {										\
+	  e.alu_mem_imm(ALU_CMP, o_IPCache, 0);						\
+	  EXIT(CC_NE, (pc_) + 4, BLOCK_RET_OK);						\
+	 }										\
+	}
+
+ e.prologue();
+
+ unsigned count = 0;
+ uint32 pc = pc0;
+ bool in_delay_slot = false;
+ bool branch_done = false;
+
+ for(;;)
+ {
+  const unsigned ici = (pc & 0xFFC) >> 2;
+  const int32 o_TV = o_ICache + ici * 8;
+  const int32 o_Data = o_TV + 4;
+  uint32 instr;
+  unsigned kind;
+
+  if(count && !PCCanTranslate(pc))
+   break;
+
+  if(!in_delay_slot && count >= BLOCK_MAX_INSTRUCTIONS)
+   break;
+
+  // Translate what will be executed; if the line isn't cached yet, what it will be filled with.
+  if(cpu->ICache[ici].TV == pc)
+   instr = cpu->ICache[ici].Data;
+  else
+   instr = LoadU32_LE((uint32 *)&cpu->FastMap[pc >> PS_CPU::FAST_MAP_SHIFT][pc]);
+
+  kind = Classify(instr);
+
+  // BIOS putchar hook and BIOS HLE in the interpreter.
+  if(pc == 0xA0 || pc == 0xB0)
+   kind = KIND_STOP;
+
+  if(in_delay_slot && kind == KIND_BRANCH)
+   kind = KIND_STOP;
+
+  //
+  // Instruction boundary; same checks as the top of the interpreter loop, plus making sure the I-cache still
+  // holds what we translated.
+  //
+  if(!count)
+  {
+   if(kind == KIND_STOP)
+   {
+    // Leave it to the interpreter(line fill included), unless the I-cache holds something else now.
+    e.alu_mem_imm(ALU_CMP, o_TV, pc);
+    uint8 *const not_cached = e.jcc(CC_NE);
+    e.alu_mem_imm(ALU_CMP, o_Data, instr);
+    EXIT(CC_NE, ~0U, BLOCK_RET_STALE_ENTRY);
+    X64Emitter::patch(not_cached, e.pos);
+    e.mov_imm(X_EAX, BLOCK_RET_INTERPRET);
+    e.epilogue();
+    break;
+   }
+
+   e.alu_mem_imm(ALU_CMP, o_TV, pc);
+   EMIT_MISS(pc);
+   e.alu_mem_imm(ALU_CMP, o_Data, instr);
+   EXIT(CC_NE, ~0U, BLOCK_RET_STALE_ENTRY);
+  }
+  else
+  {
+   if(kind == KIND_STOP)
+    break;
+
+   e.alu(ALU_CMP, X_EBP, o_NextTS);
+   EXIT(CC_GE, pc, BLOCK_RET_OK);
+
+   e.alu_mem_imm(ALU_CMP, o_TV, pc);
+   EMIT_MISS(pc);
+   e.alu_mem_imm(ALU_CMP, o_Data, instr);
+   EXIT(CC_NE, pc, BLOCK_RET_STALE);
+  }
+
+  //
+  // Fetch timing:
+  //  if(ReadAbsorb[ReadAbsorbWhich])
+  //   ReadAbsorb[ReadAbsorbWhich]--;
+  //  else
+  //   timestamp++;
+  //
+  e.load8zx(X_EAX, o_RAWhich);
+  e.u8(0x80); e.mem_rax(7, 0, o_RA); e.u8(0x00);		// cmp byte [rbx + rax + RA], 0
+  absorbs[num_absorbs].rel = e.jcc(CC_NE);
+  e.u8(0xFF); e.u8(0xC5);					// inc ebp
+  absorbs[num_absorbs].resume = e.pos;
+  num_absorbs++;
+
+  const unsigned op = instr >> 26;
+  const unsigned funct = instr & 0x3F;
+  const unsigned rs = (instr >> 21) & 0x1F;
+  const unsigned rt = (instr >> 16) & 0x1F;
+  const unsigned rd = (instr >> 11) & 0x1F;
+  const unsigned shamt = (instr >> 6) & 0x1F;
+  const uint32 imm_se = (int16)(instr & 0xFFFF);
+  const uint32 imm_ze = instr & 0xFFFF;
+
+  #define GPR_OFFS(n) (o_GPR + (n) * 4)
+  #define GPR_DEPRES(a, b, c) {									\
+	 const unsigned dr_[3] = { (a), (b), (c) };						\
+	 for(unsigned i_ = 0; i_ < 3; i_++)							\
+	  if(dr_[i_] && (i_ == 0 || dr_[i_] != dr_[0]) && (i_ < 2 || dr_[i_] != dr_[1]))	\
+	   e.store8_imm(o_RA + dr_[i_], 0);							\
+	}
+
+  //
+  // DO_LDS()
+  //
+  #define EMIT_DO_LDS() {										\
+	 if(ld < 0)											\
+	 {												\
+	  e.load(X_EAX, o_LDWhich);									\
+	  e.load(X_ECX, o_LDValue);									\
+	  e.u8(0x89); e.mem_rax(X_ECX, 2, o_GPR);	/* mov [rbx + rax * 4 + GPR], ecx */		\
+	  e.load(X_ECX, o_LDAbsorb);									\
+	  e.u8(0x88); e.mem_rax(X_ECX, 0, o_RA);	/* mov [rbx + rax + RA], cl */			\
+	  e.store8(o_ReadFudge, X_EAX);									\
+	  e.alu_imm(ALU_AND, X_EAX, 0x1F);								\
+	  e.u8(0x08); e.mem(X_EAX, o_RAWhich);		/* or [RAWhich], al */				\
+	  e.store_imm(o_LDWhich, 0x20);									\
+	  e.store_imm(GPR_OFFS(0), 0);									\
+	  fudge_none = false;										\
+	  dummy_synced = false;										\
+	 }												\
+	 else if(ld < 0x20)										\
+	 {												\
+	  if(ld)											\
+	  {												\
+	   e.load(X_EAX, o_LDValue);									\
+	   e.store(GPR_OFFS(ld), X_EAX);								\
+	  }												\
+	  e.load(X_EAX, o_LDAbsorb);									\
+	  e.store8(o_RA + ld, X_EAX);									\
+	  e.store8_imm(o_ReadFudge, ld);								\
+	  if(ld)											\
+	   e.alu8_mem_imm(ALU_OR, o_RAWhich, ld);							\
+	  e.store_imm(o_LDWhich, 0x20);									\
+	  fudge_none = false;										\
+	 }												\
+	 else												\
+	 {												\
+	  if(!dummy_synced)										\
+	  {												\
+	   e.load(X_EAX, o_LDAbsorb);									\
+	   e.store8(o_RADummy, X_EAX);									\
+	   dummy_synced = true;										\
+	  }												\
+	  if(!fudge_none)										\
+	  {												\
+	   e.store8_imm(o_ReadFudge, 0x20);								\
+	   fudge_none = true;										\
+	  }												\
+	 }												\
+	 ld = 0x20;											\
+	}
+
+  if(kind == KIND_ALU)
+  {
+   if(op == 0x0F)	// LUI
+    GPR_DEPRES(rt, 0, 0)
+   else if(op)
+    GPR_DEPRES(rs, rt, 0)
+   else if(funct < 0x04)	// SLL SRL SRA
+    GPR_DEPRES(rt, rd, 0)
+   else
+    GPR_DEPRES(rs, rt, rd)
+
+   const unsigned dest = op ? rt : rd;
+
+   if(dest)
+   {
+    if(!op)
+    {
+     switch(funct)
+     {
+      case 0x00: case 0x02: case 0x03:
+	e.load(X_EDX, GPR_OFFS(rt));
+	if(shamt)
+	 e.shift_edx_imm((funct == 0x00) ? 4 : ((funct == 0x02) ? 5 : 7), shamt);
+	break;
+
+      case 0x04: case 0x06: case 0x07:
+	e.load(X_ECX, GPR_OFFS(rs));
+	e.load(X_EDX, GPR_OFFS(rt));
+	e.shift_edx_cl((funct == 0x04) ? 4 : ((funct == 0x06) ? 5 : 7));
+	break;
+
+      case 0x21: e.load(X_EDX, GPR_OFFS(rs)); e.alu(ALU_ADD, X_EDX, GPR_OFFS(rt)); break;
+      case 0x23: e.load(X_EDX, GPR_OFFS(rs)); e.alu(ALU_SUB, X_EDX, GPR_OFFS(rt)); break;
+      case 0x24: e.load(X_EDX, GPR_OFFS(rs)); e.alu(ALU_AND, X_EDX, GPR_OFFS(rt)); break;
+      case 0x25: e.load(X_EDX, GPR_OFFS(rs)); e.alu(ALU_OR, X_EDX, GPR_OFFS(rt)); break;
+      case 0x26: e.load(X_EDX, GPR_OFFS(rs)); e.alu(ALU_XOR, X_EDX, GPR_OFFS(rt)); break;
+      case 0x27: e.load(X_EDX, GPR_OFFS(rs)); e.alu(ALU_OR, X_EDX, GPR_OFFS(rt)); e.not_edx(); break;
+
+      case 0x2A: case 0x2B:
+	e.xor_self(X_EDX);
+	e.load(X_EAX, GPR_OFFS(rs));
+	e.alu(ALU_CMP, X_EAX, GPR_OFFS(rt));
+	e.setcc_dl((funct == 0x2A) ? CC_L : CC_B);
+	break;
+     }
+    }
+    else
+    {
+     switch(op)
+     {
+      case 0x09: e.load(X_EDX, GPR_OFFS(rs)); e.alu_imm(ALU_ADD, X_EDX, imm_se); break;
+      case 0x0C: e.load(X_EDX, GPR_OFFS(rs)); e.alu_imm(ALU_AND, X_EDX, imm_ze); break;
+      case 0x0D: e.load(X_EDX, GPR_OFFS(rs)); e.alu_imm(ALU_OR, X_EDX, imm_ze); break;
+      case 0x0E: e.load(X_EDX, GPR_OFFS(rs)); e.alu_imm(ALU_XOR, X_EDX, imm_ze); break;
+      case 0x0F: e.mov_imm(X_EDX, imm_ze << 16); break;
+
+      case 0x0A: case 0x0B:
+	e.xor_self(X_EDX);
+	e.alu_mem_imm(ALU_CMP, GPR_OFFS(rs), imm_se);
+	e.setcc_dl((op == 0x0A) ? CC_L : CC_B);
+	break;
+     }
+    }
+   }
+
+   EMIT_DO_LDS();
+
+   if(dest)
+    e.store(GPR_OFFS(dest), X_EDX);
+  }
+  else if(kind == KIND_BRANCH)
+  {
+   if(!op)	// JR, JALR
+   {
+    GPR_DEPRES(rs, rd, 0);
+    e.load(X_EDX, GPR_OFFS(rs));
+    EMIT_DO_LDS();
+    if(funct == 0x09 && rd)
+     e.store_imm(GPR_OFFS(rd), pc + 8);
+    e.store(o_NPC, X_EDX);
+    e.store_imm(o_NPCM, 0);
+   }
+   else if(op == 0x02 || op == 0x03)	// J, JAL
+   {
+    if(op == 0x03)
+     e.store8_imm(o_RA + 31, 0);
+    EMIT_DO_LDS();
+    if(op == 0x03)
+     e.store_imm(GPR_OFFS(31), pc + 8);
+    e.store_imm(o_NPC, (instr & ((1 << 26) - 1)) << 2);
+    e.store_imm(o_NPCM, 0xF0000000);
+   }
+   else
+   {
+    switch(op)
+    {
+     case 0x01:	// BCOND
+	GPR_DEPRES(rs, (rt & 0x10) ? 31U : 0U, 0);
+	e.load(X_EAX, GPR_OFFS(rs));
+	if(rt & 1)
+	 e.alu_imm(ALU_XOR, X_EAX, 0x80000000);
+	e.test_eax();
+	e.setcc_dl(CC_S);
+	break;
+
+     case 0x04:	// BEQ
+     case 0x05:	// BNE
+	GPR_DEPRES(rs, rt, 0);
+	e.load(X_EAX, GPR_OFFS(rs));
+	e.alu(ALU_CMP, X_EAX, GPR_OFFS(rt));
+	e.setcc_dl((op == 0x04) ? CC_E : CC_NE);
+	break;
+
+     case 0x06:	// BLEZ
+     case 0x07:	// BGTZ
+	GPR_DEPRES(rs, 0, 0);
+	e.alu_mem_imm(ALU_CMP, GPR_OFFS(rs), 0);
+	e.setcc_dl((op == 0x06) ? CC_LE : CC_G);
+	break;
+    }
+
+    EMIT_DO_LDS();
+
+    if(op == 0x01 && (rt & 0x10))
+     e.store_imm(GPR_OFFS(31), pc + 8);
+
+    // Not taken leaves new_PC and new_PC_mask at 4 and ~0, same as the interpreter.
+    e.test_dl();
+    uint8 *not_taken = e.jcc(CC_E);
+    e.store_imm(o_NPC, imm_se << 2);
+    e.store_imm(o_NPCM, ~3U);
+    X64Emitter::patch(not_taken, e.pos);
+   }
+  }
+  else if(kind == KIND_LOAD || kind == KIND_STORE)
+  {
+   //
+   // Main RAM(and its mirrors in KUSEG, KSEG0 and KSEG1) is handled inline, anything else, misalignment and cache
+   // isolation go through JIT_Op() out of line.
+   //
+   const unsigned size = ((op & 0x3) == 0x3) ? 4 : ((op & 0x3) + 1);
+   const int pre_ld = ld;
+
+   if(kind == KIND_LOAD)
+    GPR_DEPRES(rs, 0, 0)
+   else
+    GPR_DEPRES(rs, rt, 0)
+
+   e.load(X_EDX, GPR_OFFS(rs));
+   if(imm_se)
+    e.alu_imm(ALU_ADD, X_EDX, imm_se);
+
+   e.u8(0x89); e.u8(0xD0);				// mov eax, edx
+   e.u8(0xC1); e.u8(0xE8); e.u8(29);			// shr eax, 29
+   e.mov_imm(X_ECX, (1U << 0) | (1U << 4) | (1U << 5));
+   e.u8(0x0F); e.u8(0xA3); e.u8(0xC1);			// bt ecx, eax
+   slows[num_slows].rel[0] = e.jcc(CC_AE);
+   e.u8(0xF7); e.u8(0xC2); e.u32(0x1F800000 | (size - 1));	// test edx, imm32
+   slows[num_slows].rel[1] = e.jcc(CC_NE);
+   if(kind == KIND_STORE)
+   {
+    e.u8(0xF7); e.mem(0, o_SR); e.u32(0x10000);		// test dword [SR], imm32
+    slows[num_slows].rel[2] = e.jcc(CC_NE);
+   }
+   else
+    slows[num_slows].rel[2] = NULL;
+
+   e.alu_imm(ALU_AND, X_EDX, 0x1FFFFF);
+
+   if(kind == KIND_LOAD)
+   {
+    EMIT_DO_LDS();
+
+    // ReadMemory()
+    e.load8zx(X_EAX, o_RAWhich);
+    e.u8(0xC6); e.mem_rax(0, 0, o_RA); e.u8(0);		// mov byte [rbx + rax + RA], 0
+    e.store8_imm(o_RAWhich, 0);
+
+    if(pre_ld < 0)
+    {
+     e.load8zx(X_EAX, o_ReadFudge);
+     e.u8(0xC1); e.u8(0xE8); e.u8(4);			// shr eax, 4
+     e.alu_imm(ALU_AND, X_EAX, 2);
+     e.u8(0x01); e.u8(0xC5);				// add ebp, eax
+    }
+    else if((pre_ld >> 4) & 2)
+     e.alu_imm(ALU_ADD, X_EBP, (pre_ld >> 4) & 2);
+
+    e.u8(0x48); e.u8(0xB8); e.u64((uint64)(uintptr_t)PSX_GetDMASuckSuckPtr());	// mov rax, imm64
+    e.u8(0x8B); e.u8(0x00);				// mov eax, [rax]
+    e.alu_imm(ALU_ADD, X_EAX, 3 + 2);
+    e.store(o_LDAbsorb, X_EAX);
+    e.u8(0x01); e.u8(0xC5);				// add ebp, eax
+
+    e.ram_load(size, !(op & 0x4));
+    e.store(o_LDValue, X_ECX);
+    e.store_imm(o_LDWhich, rt);
+   }
+   else
+   {
+    e.load(X_ECX, GPR_OFFS(rt));
+    e.ram_store(size);
+
+    EMIT_DO_LDS();
+   }
+
+   slows[num_slows].resume = e.pos;
+   slows[num_slows].instr = instr;
+   slows[num_slows].pc = pc;
+   slows[num_slows].zero_r0 = (pre_ld <= 0);
+   slows[num_slows].check_ipc = !in_delay_slot;
+   num_slows++;
+
+   ld = (kind == KIND_LOAD) ? (int)rt : 0x20;
+   fudge_none = false;
+   dummy_synced = false;
+  }
+  else	// KIND_HELPER, KIND_HELPER_LOAD
+  {
+   EMIT_HELPER(instr, pc, ld <= 0, !in_delay_slot);
+
+   ld = (kind == KIND_HELPER_LOAD) ? (int)rt : 0x20;
+   fudge_none = false;
+   dummy_synced = false;
+  }
+
+  #undef EMIT_DO_LDS
+  #undef GPR_DEPRES
+  #undef GPR_OFFS
+
+  count++;
+  pc += 4;
+
+  if(in_delay_slot)
+  {
+   // PC = (PC & new_PC_mask) + new_PC, with PC being the delay slot's.
+   e.load(X_EAX, o_NPCM);
+   e.u8(0x25); e.u32(pc - 4);	// and eax, imm32
+   e.alu(ALU_ADD, X_EAX, o_NPC);
+   e.store(o_PC, X_EAX);
+   e.store_imm(o_NPC, 4);
+   e.store_imm(o_NPCM, ~0U);
+   e.mov_imm(X_EAX, BLOCK_RET_OK);
+   e.epilogue();
+   branch_done = true;
+   break;
+  }
+
+  in_delay_slot = (kind == KIND_BRANCH);
+ }
+
+ if(count && !branch_done)
+ {
+  // Fell off the end, or stopped on something we don't translate(maybe a delay slot, with new_PC/new_PC_mask
+  // already set up for the interpreter).
+  e.store_imm(o_PC, pc);
+  e.mov_imm(X_EAX, BLOCK_RET_OK);
+  e.epilogue();
+ }
+
+ for(unsigned i = 0; i < num_absorbs; i++)
+ {
+  X64Emitter::patch(absorbs[i].rel, e.pos);
+  e.u8(0xFE); e.mem_rax(1, 0, o_RA);				// dec byte [rbx + rax + RA]
+  X64Emitter::patch(e.jmp(), absorbs[i].resume);
+ }
+
+ for(unsigned i = 0; i < num_slows; i++)
+ {
+  for(unsigned j = 0; j < 3; j++)
+   if(slows[i].rel[j])
+    X64Emitter::patch(slows[i].rel[j], e.pos);
+
+  EMIT_HELPER(slows[i].instr, slows[i].pc, slows[i].zero_r0, slows[i].check_ipc);
+  X64Emitter::patch(e.jmp(), slows[i].resume);
+ }
+ #undef EMIT_HELPER
+
+ for(unsigned i = 0; i < num_misses; i++)
+ {
+  X64Emitter::patch(misses[i].rel, e.pos);
+
+  e.mov_arg0_rbx();
+  e.mov_imm(ArgRegs[1], misses[i].pc);
+  e.call_helper((const void *)&PS_CPU::JIT_ICacheMissThunk);
+  e.test_eax();
+  X64Emitter::patch(e.jcc(CC_NE), misses[i].resume);
+
+  if(misses[i].pc == pc0)
+   e.mov_imm(X_EAX, BLOCK_RET_INTERPRET);
+  else
+  {
+   e.store_imm(o_PC, misses[i].pc);
+   e.mov_imm(X_EAX, BLOCK_RET_OK);
+  }
+  e.epilogue();
+ }
+ #undef EMIT_MISS
+
+ for(unsigned i = 0; i < num_exits; i++)
+ {
+  X64Emitter::patch(exits[i].rel, e.pos);
+
+  if(exits[i].pc != ~0U)
+   e.store_imm(o_PC, exits[i].pc);
+
+  e.mov_imm(X_EAX, exits[i].ret);
+  e.epilogue();
+ }
+ #undef EXIT
+
+ CodePos = e.pos;
+
+ return (BlockFunc)code;
+}
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef __MDFN_PSX_CPU_JIT_H
+#define __MDFN_PSX_CPU_JIT_H
+
+/*
+ Dynamic recompiler for PS_CPU, x86-64 hosts only.
+
+ Straight-line MIPS code out of main RAM is translated into host code one block at a time; a block ends on a branch(plus its
+ delay slot), on any instruction we don't translate, or after BLOCK_MAX_INSTRUCTIONS.  ALU ops, branches and loads/stores
+ that hit main RAM are emitted inline, everything else that can be translated(other memory accesses, mult/div, COP2) calls back
+ into PS_CPU::JIT_Op(), which runs the interpreter's own instruction bodies(cpu_ops.inc).
+
+ Blocks keep all R3000A state in the PS_CPU object(the BACKED_* registers, ReadAbsorb etc.), so a block can be left at
+ any instruction boundary and the interpreter picks up where it left off.  Before each instruction, a block checks
+ next_event_ts, does the I-cache lookup(and line fill on a miss) like the interpreter, and makes sure the word fetched is
+ the one the block was translated from; RAM writes(CPU, DMA) and isolated cache writes are thus caught without any extra
+ hooks in the memory write paths.
+*/
+
+namespace MDFN_IEN_PSX
+{
+
+class PS_CPU;
+
+class PS_CPU_JIT
+{
+ public:
+
+ PS_CPU_JIT(PS_CPU *cpu_arg) MDFN_COLD;
+ ~PS_CPU_JIT() MDFN_COLD;
+
+ // Returns false if no memory for the code cache could be allocated.
+ bool Init(void) MDFN_COLD;
+
+ // Throw away all translated blocks.
+ void Flush(void);
+
+ // Runs one block at CPU->BACKED_PC with CPU->JIT_timestamp, returns false if nothing was executed and the
+ // interpreter should execute the instruction at PC itself.
+ bool Execute(void);
+
+ private:
+
+ enum { BLOCK_MAX_INSTRUCTIONS = 64 };
+ enum { CODE_CACHE_SIZE = 32 * 1024 * 1024 };
+ enum { CODE_CACHE_BLOCK_SLACK = 128 * 1024 };	// Worst-case size of one block, and then some.
+
+ enum
+ {
+  BLOCK_RET_INTERPRET = 0,	// I-cache is disabled or first instruction is untranslatable, nothing executed.
+  BLOCK_RET_OK = 1,
+  BLOCK_RET_STALE_ENTRY = 2,	// First instruction doesn't match the translated code, nothing executed.
+  BLOCK_RET_STALE = 3		// Executed up to an instruction that doesn't match the translated code.
+ };
+
+ typedef uint32 (*BlockFunc)(PS_CPU *cpu);
+
+ struct BlockEntry
+ {
+  BlockFunc func;
+  uint32 pc;
+  uint32 idle_len;	// See PS_CPU::IdleLoop_Analyze()
+ };
+
+ static INLINE bool PCCanTranslate(uint32 pc)
+ {
+  // Main RAM and its mirrors, through KUSEG and KSEG0(KSEG1 is uncached, left to the interpreter).
+  return !(pc & 0x7F800000);
+ }
+
+ static INLINE uint32 PCToIndex(uint32 pc)
+ {
+  return (pc & 0x1FFFFC) >> 2;
+ }
+
+ BlockFunc Compile(uint32 pc);
+
+ PS_CPU *cpu;
+
+ BlockEntry *Blocks;	// [2048 * 1024 / 4]
+
+ uint8 *CodeBase;
+ uint8 *CodePos;
+};
+
+}
+
+#endif
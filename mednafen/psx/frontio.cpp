@@ -91,12 +91,24 @@ INLINE void InputDevice::DrawCrosshairs(uint32 *pixels, const MDFN_PixelFormat*
       x_start = std::max<int32>(0, chair_x - ic);
       x_bound = std::min<int32>(width, chair_x + ic + 1);
 
+#ifdef WANT_16BPP
+      uint16 *pixels16 = (uint16 *)pixels;	// See ScanoutPixel in gpu.h
+#endif
+
       for(int32 x = x_start; x < x_bound; x++)
       {
-         int r, g, b, a;
+         int r, g, b;
          int nr, ng, nb;
 
+#ifdef WANT_16BPP
+         r = ((pixels16[x] & RED_MASK) >> RED_SHIFT) << RED_EXPAND;
+         g = ((pixels16[x] & GREEN_MASK) >> GREEN_SHIFT) << GREEN_EXPAND;
+         b = ((pixels16[x] & BLUE_MASK) >> BLUE_SHIFT) << BLUE_EXPAND;
+#else
+         int a;
+
          format->DecodeColor(pixels[x], r, g, b, a);
+#endif
 
          nr = (r + chair_r * 3) >> 2;
          ng = (g + chair_g * 3) >> 2;
@@ -118,7 +130,11 @@ INLINE void InputDevice::DrawCrosshairs(uint32 *pixels, const MDFN_PixelFormat*
             }
          }
 
+#ifdef WANT_16BPP
+         pixels16[x] = MAKECOLOR(nr, ng, nb, 0);
+#else
          pixels[x] = format->MakeColor(nr, ng, nb, a);
+#endif
       }
    }
 }
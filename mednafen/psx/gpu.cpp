@@ -96,11 +96,15 @@ static const int32_t dither_table[4][4] =
 };
 
 uint8_t DitherLUT[4][4][512];	// Y, X, 8-bit source value(256 extra for saturation)
+int16_t DitherOffset[4][4];	// Y, X; what DitherLUT[] adds before shifting, for the SIMD span kernels.
+bool DitherEnabled = true;	// As last set by PSXDitherApply(), for GPU recordings.
 
 void PSXDitherApply(bool enable)
 {
    int x, y, v;
 
+   DitherEnabled = enable;
+
    for(y = 0; y < 4; y++)
       for(x = 0; x < 4; x++)
          for(v = 0; v < 512; v++)
@@ -119,6 +123,10 @@ void PSXDitherApply(bool enable)
 
             DitherLUT[y][x][v] = value;
          }
+
+   for(y = 0; y < 4; y++)
+      for(x = 0; x < 4; x++)
+         DitherOffset[y][x] = enable ? dither_table[y][x] : 0;
 }
 
 namespace MDFN_IEN_PSX
@@ -147,6 +155,10 @@ PS_GPU::PS_GPU(bool pal_clock_and_tv, int sls, int sle) : BlitterFIFO(0x20)
             DitherLUT[y][x][v] = value;
          }
 
+   for(y = 0; y < 4; y++)
+      for(x = 0; x < 4; x++)
+         DitherOffset[y][x] = dither_table[y][x];
+
    if(HardwarePALType == false)	// NTSC clock
       GPUClockRatio = 103896; // 65536 * 53693181.818 / (44100 * 768)
    else	// PAL clock
@@ -161,11 +173,58 @@ PS_GPU::PS_GPU(bool pal_clock_and_tv, int sls, int sle) : BlitterFIFO(0x20)
 
    LineVisFirst = sls;
    LineVisLast = sle;
+
+   Renderer = NULL;
+   DrawTimingOnly = false;
+
+   RT_Ring = NULL;
+   RT_WritePos = 0;
+   RT_ReadPos = 0;
+
+#ifdef WANT_THREADING
+   RenderThread = NULL;
+#endif
+
+   Bands = NULL;
+
+   TexCache = NULL;
+   TexCacheCount = 0;
+   TexCur = NULL;
+   TexCacheClock = 0;
+   memset(TexDirty, 0, sizeof(TexDirty));
+   memset(&TexStats, 0, sizeof(TexStats));
+
+   surface = NULL;
+
+   DupFrames = false;
+   ScanoutReset = true;
+   memset(RowWrites, 0, sizeof(RowWrites));
+   memset(ScanoutLines, 0, sizeof(ScanoutLines));
+   ScanoutConverted = 0;
+   ScanoutSkipped = 0;
+
+   SkipDraw = false;
+   SkipCmdLogged = false;
+   SkipCmdRect = 0;
+   memset(SkipLogEnv, 0, sizeof(SkipLogEnv));
+   memset(SkipRects, 0, sizeof(SkipRects));
+   memset(&SkipStats, 0, sizeof(SkipStats));
+
+   RecFile = NULL;
+   RecLastTS = 0;
+
+   CmdStats = NULL;
+   CmdStatsTime = NULL;
+   DrawnPixels = 0;
 }
 
 PS_GPU::~PS_GPU()
 {
+   StopRecording();
+   SetAsyncRender(false);
+   SetBandThreads(1);
 
+   TexCacheFree();
 }
 
 void PS_GPU::FillVideoParams(MDFNGI* gi)
@@ -284,11 +343,33 @@ void PS_GPU::SoftReset(void) // Control command 0x00
    //
    MaskSetOR = 0;
    MaskEvalAND = 0;
+
+   // The drawing environment values above are what commands 0xE1 through 0xE6 with all-zero parameters set, so have the renderer
+   // run those.
+   if(Renderer)
+   {
+      for(uint32 cc = 0xE1; cc <= 0xE6; cc++)
+      {
+         const uint32 CB = cc << 24;
+
+         RT_PushCommand(RT_CMD_NEW, &CB, 1);
+      }
+   }
 }
 
 void PS_GPU::Power(void)
 {
+   const bool async_render = (Renderer != NULL);
+
+   if(MDFN_UNLIKELY(RecFile != NULL))
+      RecBuf.push_back(REC_POWER);
+
+   // Start over with a fresh renderer copy afterwards, rather than trying to mirror all of the below.
+   SetAsyncRender(false);
+
    memset(GPURAM, 0, sizeof(GPURAM));
+   MarkVRAMDirty(0, 0, 1024, 512);
+   SkipClear();
 
    DMAControl = 0;
 
@@ -375,13 +456,147 @@ void PS_GPU::Power(void)
 
    IRQ_Assert(IRQ_VBLANK, InVBlank);
    TIMER_SetVBlank(InVBlank);
+
+   SetAsyncRender(async_render);
 }
 
 void PS_GPU::ResetTS(void)
 {
+   if(MDFN_UNLIKELY(RecFile != NULL))
+   {
+      RecBuf.push_back(REC_RESET_TS);
+      RecLastTS = 0;
+   }
+
    lastts = 0;
 }
 
+int PS_GPU::StateAction(StateMem *sm, int load, int data_only)
+{
+   const bool async_render = (Renderer != NULL);
+
+   // GPURAM is only complete here with the render thread stopped and nothing put off by frameskip.
+   SetAsyncRender(false);
+
+   if(!load)
+      SkipCatchUp();
+
+   SFORMAT StateRegs[] =
+   {
+      SFARRAY16(&GPURAM[0][0], sizeof(GPURAM) / sizeof(GPURAM[0][0])),
+
+      SFVAR(DMAControl),
+
+      SFVAR(ClipX0),
+      SFVAR(ClipY0),
+      SFVAR(ClipX1),
+      SFVAR(ClipY1),
+
+      SFVAR(OffsX),
+      SFVAR(OffsY),
+
+      SFVAR(dtd),
+      SFVAR(dfe),
+
+      SFVAR(MaskSetOR),
+      SFVAR(MaskEvalAND),
+
+      SFVAR(tww),
+      SFVAR(twh),
+      SFVAR(twx),
+      SFVAR(twy),
+
+      SFVAR(TexPageX),
+      SFVAR(TexPageY),
+
+      SFVAR(SpriteFlip),
+
+      SFVAR(abr),
+      SFVAR(TexMode),
+
+      SFARRAY32(&BlitterFIFO.data[0], BlitterFIFO.data.size()),
+      SFVAR(BlitterFIFO.read_pos),
+      SFVAR(BlitterFIFO.write_pos),
+      SFVAR(BlitterFIFO.in_count),
+
+      SFVAR(DataReadBuffer),
+
+      SFVAR(IRQPending),
+
+      SFVAR(InCmd),
+      SFVAR(InCmd_CC),
+
+      SFARRAY32(&InQuad_F3Vertices[0].x, (sizeof(tri_vertex) / sizeof(int32)) * 3),
+      SFVAR(InQuad_clut),
+
+      SFVAR(InPLine_PrevPoint.x),
+      SFVAR(InPLine_PrevPoint.y),
+      SFVAR(InPLine_PrevPoint.r),
+      SFVAR(InPLine_PrevPoint.g),
+      SFVAR(InPLine_PrevPoint.b),
+
+      SFVAR(FBRW_X),
+      SFVAR(FBRW_Y),
+      SFVAR(FBRW_W),
+      SFVAR(FBRW_H),
+      SFVAR(FBRW_CurY),
+      SFVAR(FBRW_CurX),
+
+      SFVAR(DisplayMode),
+      SFVAR(DisplayOff),
+      SFVAR(DisplayFB_XStart),
+      SFVAR(DisplayFB_YStart),
+
+      SFVAR(HorizStart),
+      SFVAR(HorizEnd),
+
+      SFVAR(VertStart),
+      SFVAR(VertEnd),
+
+      SFVAR(DisplayFB_CurYOffset),
+      SFVAR(DisplayFB_CurLineYReadout),
+
+      SFVAR(InVBlank),
+
+      SFVAR(LinesPerField),
+      SFVAR(scanline),
+      SFVAR(field),
+      SFVAR(field_ram_readout),
+      SFVAR(PhaseChange),
+
+      SFVAR(DotClockCounter),
+
+      SFVAR(GPUClockCounter),
+      SFVAR(LineClockCounter),
+      SFVAR(LinePhase),
+
+      SFVAR(DrawTimeAvail),
+
+      SFVAR(lastts),
+
+      SFEND
+   };
+
+   int ret = MDFNSS_StateAction(sm, load, data_only, StateRegs, "GPU");
+
+   if(load)
+   {
+      BlitterFIFO.read_pos &= BlitterFIFO.data.size() - 1;
+      BlitterFIFO.write_pos &= BlitterFIFO.data.size() - 1;
+      BlitterFIFO.in_count = std::min<uint32>(BlitterFIFO.in_count, BlitterFIFO.size);
+
+      RecalcTexWindowLUT();
+
+      MarkVRAMDirty(0, 0, 1024, 512);
+      SkipClear();
+      ScanoutReset = true;
+   }
+
+   SetAsyncRender(async_render);
+
+   return(ret);
+}
+
 template<int BlendMode, bool MaskEval_TA, bool textured>
 INLINE void PS_GPU::PlotPixel(int32 x, int32 y, uint16_t fore_pix)
 {
@@ -469,6 +684,20 @@ INLINE uint16_t PS_GPU::ModTexel(uint16_t texel, int32 r, int32 g, int32 b, cons
    return(ret);
 }
 
+#include "gpu_texcache.inc"
+
+void PS_GPU::MarkVRAMDirty(int32 x, int32 y, int32 w, int32 h)
+{
+   if(TexCacheCount)
+      TexCacheMarkBlocks(TexDirty, x, y, w, h);
+
+   if(DupFrames && w > 0)
+   {
+      for(int32 i = 0; i < std::min<int32>(h, 512); i++)
+         RowWrites[(y + i) & 511]++;
+   }
+}
+
 template<uint32_t TexMode_TA>
 INLINE uint16_t PS_GPU::GetTexel(const uint32_t clut_offset, int32 u_arg, int32 v_arg)
 {
@@ -477,6 +706,15 @@ INLINE uint16_t PS_GPU::GetTexel(const uint32_t clut_offset, int32 u_arg, int32
 
    u = TexWindowXLUT[u_arg];
    v = TexWindowYLUT[v_arg];
+
+   if(TexMode_TA != 2 && TexCur)
+   {
+      if(MDFN_UNLIKELY(!TexCur->row_valid[v]))
+         TexCacheDecodeRow<TexMode_TA>(TexCur, v);
+
+      return(TexCur->texels[v][u]);
+   }
+
    fbtex_x = TexPageX + (u >> (2 - TexMode_TA));
    fbtex_y = TexPageY + v;
    fbw = GPURAM[fbtex_y][fbtex_x & 1023];
@@ -508,14 +746,44 @@ INLINE bool PS_GPU::LineSkipTest(unsigned y)
    return false;
 }
 
+#include "gpu_bands.inc"
+#include "gpu_simd.inc"
 #include "gpu_polygon.inc"
 #include "gpu_sprite.inc"
 #include "gpu_line.inc"
 
+struct fb_fill
+{
+   int32 destX, destY, width;
+   uint16 fill_value;
+};
+
+// Fills rows [y0, y1), relative to the fill's destination.
+void PS_GPU::FBFillRows(const void *arg, int32 y0, int32 y1)
+{
+   const fb_fill &f = *(const fb_fill *)arg;
+
+   for(int32 y = y0; y < y1; y++)
+   {
+      const int32 d_y = (y + f.destY) & 511;
+
+      if(LineSkipTest(d_y))
+         continue;
+
+      // destX is a multiple of 16 and width at most 1024, so the row wraps around at most once.
+      {
+         const int32 first = std::min<int32>(f.width, 1024 - f.destX);
+
+         std::fill(&GPURAM[d_y][f.destX], &GPURAM[d_y][f.destX] + first, f.fill_value);
+         std::fill(&GPURAM[d_y][0], &GPURAM[d_y][0] + (f.width - first), f.fill_value);
+      }
+   }
+}
+
 // Special RAM write mode(16 pixels at a time), does *not* appear to use mask drawing environment settings.
 INLINE void PS_GPU::Command_FBFill(const uint32_t *cb)
 {
-   int32_t x, y, r, g, b, destX, destY, width, height;
+   int32_t r, g, b, destX, destY, width, height;
    r = cb[0] & 0xFF;
    g = (cb[0] >> 8) & 0xFF;
    b = (cb[0] >> 16) & 0xFF;
@@ -530,21 +798,79 @@ INLINE void PS_GPU::Command_FBFill(const uint32_t *cb)
    //printf("[GPU] FB Fill %d:%d w=%d, h=%d\n", destX, destY, width, height);
    DrawTimeAvail -= 46;	// Approximate
    DrawTimeAvail -= ((width * height) >> 3) + (height * 9);
+   DrawnPixels += width * height;
+
+   if(DrawTimingOnly)
+      return;
+
+   // Rows that LineSkipTest() leaves out keep what was drawn there.
+   SkipWrite(destX, destY, width, height, (DisplayMode & 0x24) != 0x24 || dfe);
+   MarkVRAMDirty(destX, destY, width, height);
 
-   for(y = 0; y < height; y++)
    {
-      const int32 d_y = (y + destY) & 511;
+      fb_fill f;
 
-      if(LineSkipTest(d_y))
-         continue;
+      f.destX = destX;
+      f.destY = destY;
+      f.width = width;
+      f.fill_value = fill_value;
 
-      for(x = 0; x < width; x++)
-      {
-         const int32 d_x = (x + destX) & 1023;
+      if(UseBands(height, width * height))
+         RunBands(&PS_GPU::FBFillRows, &f, 0, height);
+      else
+         FBFillRows(&f, 0, height);
+   }
+}
 
-         GPURAM[d_y][d_x] = fill_value;
-      }
+struct fb_copy
+{
+ int32 sourceX, sourceY;
+ int32 destX, destY;
+ int32 width;
+};
+
+// Copies rows [y0, y1), relative to the copy's source and destination.
+void PS_GPU::FBCopyRows(const void *arg, int32 y0, int32 y1)
+{
+ const fb_copy &c = *(const fb_copy *)arg;
+
+ for(int32 y = y0; y < y1; y++)
+ {
+  for(int32 x = 0; x < c.width; x += 128)
+  {
+   const int32 chunk_x_max = std::min<int32>(c.width - x, 128);
+   uint16 tmpbuf[128];	// TODO: Check and see if the GPU is actually (ab)using the CLUT or texture cache.
+
+   // Each chunk is read whole before it's written, as memmove() does, so this is the same even where source and destination overlap.
+   {
+    const int32 s_x = (x + c.sourceX) & 1023;
+    const int32 d_x = (x + c.destX) & 1023;
+
+    if(!MaskEvalAND && !MaskSetOR && (s_x + chunk_x_max) <= 1024 && (d_x + chunk_x_max) <= 1024)
+    {
+     memmove(&GPURAM[(y + c.destY) & 511][d_x], &GPURAM[(y + c.sourceY) & 511][s_x], chunk_x_max * sizeof(uint16));
+     continue;
+    }
+   }
+
+   for(int32 chunk_x = 0; chunk_x < chunk_x_max; chunk_x++)
+   {
+    int32 s_y = (y + c.sourceY) & 511;
+    int32 s_x = (x + chunk_x + c.sourceX) & 1023;
+
+    tmpbuf[chunk_x] = GPURAM[s_y][s_x];
+   }
+
+   for(int32 chunk_x = 0; chunk_x < chunk_x_max; chunk_x++)
+   {
+    int32 d_y = (y + c.destY) & 511;
+    int32 d_x = (x + chunk_x + c.destX) & 1023;
+
+    if(!(GPURAM[d_y][d_x] & MaskEvalAND))
+     GPURAM[d_y][d_x] = tmpbuf[chunk_x] | MaskSetOR;
    }
+  }
+ }
 }
 
 INLINE void PS_GPU::Command_FBCopy(const uint32 *cb)
@@ -566,33 +892,30 @@ INLINE void PS_GPU::Command_FBCopy(const uint32 *cb)
  //printf("FB Copy: %d %d %d %d %d %d\n", sourceX, sourceY, destX, destY, width, height);
 
  DrawTimeAvail -= (width * height) * 2;
+ DrawnPixels += width * height;
 
- for(int32 y = 0; y < height; y++)
- {
-  for(int32 x = 0; x < width; x += 128)
-  {
-   const int32 chunk_x_max = std::min<int32>(width - x, 128);
-   uint16 tmpbuf[128];	// TODO: Check and see if the GPU is actually (ab)using the CLUT or texture cache.
+ if(DrawTimingOnly)
+  return;
 
-   for(int32 chunk_x = 0; chunk_x < chunk_x_max; chunk_x++)
-   {
-    int32 s_y = (y + sourceY) & 511;
-    int32 s_x = (x + chunk_x + sourceX) & 1023;
+ SkipRead(sourceX, sourceY, width, height);
+ SkipWrite(destX, destY, width, height, !MaskEvalAND);
+ MarkVRAMDirty(destX, destY, width, height);
 
-    tmpbuf[chunk_x] = GPURAM[s_y][s_x];
-   }
-
-   for(int32 chunk_x = 0; chunk_x < chunk_x_max; chunk_x++)
-   {
-    int32 d_y = (y + destY) & 511;
-    int32 d_x = (x + chunk_x + destX) & 1023;
-
-    if(!(GPURAM[d_y][d_x] & MaskEvalAND))
-     GPURAM[d_y][d_x] = tmpbuf[chunk_x] | MaskSetOR;
-   }
-  }
+ {
+  fb_copy c;
+
+  c.sourceX = sourceX;
+  c.sourceY = sourceY;
+  c.destX = destX;
+  c.destY = destY;
+  c.width = width;
+
+  // Bands mustn't read what other bands write.
+  if(UseBands(height, width * height) && !BandRectsOverlap(sourceX, sourceY, width, height, destX, destY, width, height))
+   RunBands(&PS_GPU::FBCopyRows, &c, 0, height);
+  else
+   FBCopyRows(&c, 0, height);
  }
-
 }
 
 INLINE void PS_GPU::Command_FBWrite(const uint32_t *cb)
@@ -614,6 +937,13 @@ INLINE void PS_GPU::Command_FBWrite(const uint32_t *cb)
    FBRW_CurX = FBRW_X;
    FBRW_CurY = FBRW_Y;
 
+   if(!DrawTimingOnly)
+      SkipWrite(FBRW_X, FBRW_Y, FBRW_W, FBRW_H, false);
+
+   MarkVRAMDirty(FBRW_X, FBRW_Y, FBRW_W, FBRW_H);
+
+   DrawnPixels += FBRW_W * FBRW_H;
+
    if(FBRW_W != 0 && FBRW_H != 0)
       InCmd = INCMD_FBWRITE;
 }
@@ -637,6 +967,9 @@ INLINE void PS_GPU::Command_FBRead(const uint32_t *cb)
    FBRW_CurX = FBRW_X;
    FBRW_CurY = FBRW_Y;
 
+   if(!DrawTimingOnly)
+      SkipRead(FBRW_X, FBRW_Y, FBRW_W, FBRW_H);
+
    if(FBRW_W != 0 && FBRW_H != 0)
       InCmd = INCMD_FBREAD;
 }
@@ -816,6 +1149,66 @@ CTEntry PS_GPU::Commands[256] =
 #include "gpu_command_table.inc"
 };
 
+INLINE void PS_GPU::ExecuteCommand(const uint32 *CB)
+{
+   const uint32_t cc = CB[0] >> 24;
+   const CTEntry *command = &Commands[cc];
+
+   // A very very ugly kludge to support texture mode specialization. fixme/cleanup/SOMETHING in the future.
+   if(cc >= 0x20 && cc <= 0x3F && (cc & 0x4))
+   {
+      uint32 tpage;
+
+      tpage = CB[4 + ((cc >> 4) & 0x1)] >> 16;
+
+      TexPageX = (tpage & 0xF) * 64;
+      TexPageY = (tpage & 0x10) * 16;
+
+      SpriteFlip = tpage & 0x3000;
+
+      abr = (tpage >> 5) & 0x3;
+      TexMode = (tpage >> 7) & 0x3;
+   }
+   if(!command->func[abr][TexMode])
+   {
+      if(CB[0])
+         PSX_WARNING("[GPU] Unknown command: %08x, %d", CB[0], scanline);
+   }
+   else
+   {
+      command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](this, CB);
+   }
+}
+
+INLINE void PS_GPU::FBWriteUnit(uint32 InData)
+{
+   for(int i = 0; i < 2; i++)
+   {
+      if(!DrawTimingOnly && !(GPURAM[FBRW_CurY & 511][FBRW_CurX & 1023] & MaskEvalAND))
+         GPURAM[FBRW_CurY & 511][FBRW_CurX & 1023] = InData | MaskSetOR;
+
+      // Per pixel rather than in Command_FBWrite(), since lines can be scanned out while the transfer is still going.
+      RowWrites[FBRW_CurY & 511] += DupFrames;
+
+      FBRW_CurX++;
+      if(FBRW_CurX == (FBRW_X + FBRW_W))
+      {
+         FBRW_CurX = FBRW_X;
+         FBRW_CurY++;
+         if(FBRW_CurY == (FBRW_Y + FBRW_H))
+         {
+            InCmd = INCMD_NONE;
+            break;	// Break out of the for() loop.
+         }
+      }
+      InData >>= 16;
+   }
+}
+
+#include "gpu_frameskip.inc"
+#include "gpu_async.inc"
+#include "gpu_record.inc"
+
 
 void PS_GPU::ProcessFIFO(void)
 {
@@ -839,24 +1232,10 @@ void PS_GPU::ProcessFIFO(void)
          {
             uint32_t InData = BlitterFIFO.ReadUnit();
 
-            for(int i = 0; i < 2; i++)
-            {
-               if(!(GPURAM[FBRW_CurY & 511][FBRW_CurX & 1023] & MaskEvalAND))
-                  GPURAM[FBRW_CurY & 511][FBRW_CurX & 1023] = InData | MaskSetOR;
+            if(Renderer)
+               RT_PushFBWrite(InData);
 
-               FBRW_CurX++;
-               if(FBRW_CurX == (FBRW_X + FBRW_W))
-               {
-                  FBRW_CurX = FBRW_X;
-                  FBRW_CurY++;
-                  if(FBRW_CurY == (FBRW_Y + FBRW_H))
-                  {
-                     InCmd = INCMD_NONE;
-                     break;	// Break out of the for() loop.
-                  }
-               }
-               InData >>= 16;
-            }
+            FBWriteUnit(InData);
             return;
          }
          break;
@@ -867,7 +1246,6 @@ void PS_GPU::ProcessFIFO(void)
                return;
 
             const uint32_t cc = InCmd_CC;
-            const CTEntry *command = &Commands[cc];
             unsigned vl = 1 + (bool)(cc & 0x4) + (bool)(cc & 0x10);
             uint32_t CB[3];
 
@@ -878,7 +1256,10 @@ void PS_GPU::ProcessFIFO(void)
                   CB[i] = BlitterFIFO.ReadUnit();
                }
 
-               command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](this, CB);
+               if(Renderer)
+                  RT_PushCommand(RT_CMD_CONT, CB, vl);
+
+               RunCommand(RT_CMD_CONT, CB, vl);
             }
             return;
          }
@@ -889,8 +1270,6 @@ void PS_GPU::ProcessFIFO(void)
             if(DrawTimeAvail < 0)
                return;
 
-            const uint32_t cc = InCmd_CC;
-            const CTEntry *command = &Commands[cc];
             unsigned vl = 1 + (bool)(InCmd_CC & 0x10);
             uint32_t CB[2];
 
@@ -908,7 +1287,10 @@ void PS_GPU::ProcessFIFO(void)
                   CB[i] = BlitterFIFO.ReadUnit();
                }
 
-               command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](this, CB);
+               if(Renderer)
+                  RT_PushCommand(RT_CMD_CONT, CB, vl);
+
+               RunCommand(RT_CMD_CONT, CB, vl);
             }
             return;
          }
@@ -941,30 +1323,11 @@ void PS_GPU::ProcessFIFO(void)
          printf("\n");
       }
 #endif
-      // A very very ugly kludge to support texture mode specialization. fixme/cleanup/SOMETHING in the future.
-      if(cc >= 0x20 && cc <= 0x3F && (cc & 0x4))
-      {
-         uint32 tpage;
-
-         tpage = CB[4 + ((cc >> 4) & 0x1)] >> 16;
+      // Unknown commands and the IRQ command(which the render thread mustn't act on) don't need to go to the renderer.
+      if(Renderer && command->func[0][0] && cc != 0x1F)
+         RT_PushCommand(RT_CMD_NEW, CB, command->len);
 
-         TexPageX = (tpage & 0xF) * 64;
-         TexPageY = (tpage & 0x10) * 16;
-
-         SpriteFlip = tpage & 0x3000;
-
-         abr = (tpage >> 5) & 0x3;
-         TexMode = (tpage >> 7) & 0x3;
-      }
-      if(!command->func[abr][TexMode])
-      {
-         if(CB[0])
-            PSX_WARNING("[GPU] Unknown command: %08x, %d", CB[0], scanline);
-      }
-      else
-      {
-         command->func[abr][TexMode | (MaskEvalAND ? 0x4 : 0x0)](this, CB);
-      }
+      RunCommand(RT_CMD_NEW, CB, command->len);
    }
 }
 
@@ -982,6 +1345,14 @@ INLINE void PS_GPU::WriteCB(uint32_t InData)
 
 void PS_GPU::Write(const pscpu_timestamp_t timestamp, uint32_t A, uint32_t V)
 {
+   if(MDFN_UNLIKELY(RecFile != NULL))
+   {
+      RecBuf.push_back(REC_WRITE);
+      RecPutTS(timestamp);
+      RecPutVar(A & 7);
+      RecPutVar(V);
+   }
+
    V <<= (A & 3) * 8;
 
    if(A & 4)	// GP1 ("Control")
@@ -1085,6 +1456,12 @@ void PS_GPU::Write(const pscpu_timestamp_t timestamp, uint32_t A, uint32_t V)
 
 void PS_GPU::WriteDMA(uint32_t V)
 {
+   if(MDFN_UNLIKELY(RecFile != NULL))
+   {
+      RecBuf.push_back(REC_WRITE_DMA);
+      RecPutVar(V);
+   }
+
    WriteCB(V);
 }
 
@@ -1092,10 +1469,12 @@ INLINE uint32_t PS_GPU::ReadData(void)
 {
    if(InCmd == INCMD_FBREAD)
    {
+      const PS_GPU *vram = SyncVRAM();
+
       DataReadBuffer = 0;
       for(int i = 0; i < 2; i++)
       {
-         DataReadBuffer |= GPURAM[FBRW_CurY & 511][FBRW_CurX & 1023] << (i * 16);
+         DataReadBuffer |= vram->GPURAM[FBRW_CurY & 511][FBRW_CurX & 1023] << (i * 16);
 
          FBRW_CurX++;
          if(FBRW_CurX == (FBRW_X + FBRW_W))
@@ -1116,7 +1495,15 @@ INLINE uint32_t PS_GPU::ReadData(void)
 
 uint32_t PS_GPU::ReadDMA(void)
 {
- return ReadData();
+ const uint32 ret = ReadData();
+
+ if(MDFN_UNLIKELY(RecFile != NULL))
+ {
+  RecBuf.push_back(REC_READ_DMA);
+  RecPutVar(ret);
+ }
+
+ return ret;
 }
 
 uint32_t PS_GPU::Read(const pscpu_timestamp_t timestamp, uint32_t A)
@@ -1172,7 +1559,17 @@ uint32_t PS_GPU::Read(const pscpu_timestamp_t timestamp, uint32_t A)
   //PSX_WARNING("[GPU READ WHEN (DMACONTROL&2)] 0x%08x - ret=0x%08x, scanline=%d", A, ret, scanline);
  }
 
- return(ret >> ((A & 3) * 8));
+ ret >>= (A & 3) * 8;
+
+ if(MDFN_UNLIKELY(RecFile != NULL))
+ {
+  RecBuf.push_back(REC_READ);
+  RecPutTS(timestamp);
+  RecPutVar(A & 7);
+  RecPutVar(ret);
+ }
+
+ return(ret);
 }
 
 /*
@@ -1184,7 +1581,7 @@ static INLINE uint32_t ShiftHelper(uint32_t val, int shamt, uint32_t mask)
   return((val << shamt) & mask);
 }
 */
-INLINE void PS_GPU::ReorderRGB_Var(uint32_t out_Rshift, uint32_t out_Gshift, uint32_t out_Bshift, bool bpp24, const uint16_t *src, uint32_t *dest, const int32 dx_start, const int32 dx_end, int32 fb_x)
+INLINE void PS_GPU::ReorderRGB_Var(bool bpp24, const uint16_t *src, ScanoutPixel *dest, const int32 dx_start, const int32 dx_end, int32 fb_x)
 {
    if(bpp24)	// 24bpp
    {
@@ -1195,8 +1592,7 @@ INLINE void PS_GPU::ReorderRGB_Var(uint32_t out_Rshift, uint32_t out_Gshift, uin
          srcpix = src[(fb_x >> 1) + 0] | (src[((fb_x >> 1) + 1) & 0x7FF] << 16);
          srcpix >>= (fb_x & 1) * 8;
 
-         dest[x] = (((srcpix >> 0) << RED_SHIFT) & (0xFF << RED_SHIFT)) | (((srcpix >> 8) << GREEN_SHIFT) & (0xFF << GREEN_SHIFT)) |
-            (((srcpix >> 16) << BLUE_SHIFT) & (0xFF << BLUE_SHIFT));
+         dest[x] = MAKECOLOR(((srcpix >> 0) & 0xFF), ((srcpix >> 8) & 0xFF), ((srcpix >> 16) & 0xFF), 0);
 
          fb_x = (fb_x + 3) & 0x7FF;
       }
@@ -1214,6 +1610,84 @@ INLINE void PS_GPU::ReorderRGB_Var(uint32_t out_Rshift, uint32_t out_Gshift, uin
 
 }
 
+#include "gpu_scanout.inc"
+
+void PS_GPU::ScanoutLine(uint32 *dest, uint32 dest_line, uint32 src_y, bool bpp24, int32 dx_start, int32 dx_end, uint32 dmw, int32 fb_x, uint32 flags)
+{
+   ScanoutLineState *ls = NULL;
+
+   // 24bpp lines take 3/2 as many GPURAM pixels; 2 is near enough.
+   SkipRead(fb_x >> 1, src_y, (dx_end - dx_start) << bpp24, 1);
+
+   if(flags & SCANOUT_RESET)
+   {
+      for(unsigned i = 0; i < sizeof(ScanoutLines) / sizeof(ScanoutLines[0]); i++)
+         ScanoutLines[i].valid = false;
+   }
+
+   if(dest_line < sizeof(ScanoutLines) / sizeof(ScanoutLines[0]))
+   {
+      ls = &ScanoutLines[dest_line];
+
+      if((flags & SCANOUT_MAY_SKIP) && ls->valid && ls->src_y == src_y && ls->row_writes == RowWrites[src_y] && ls->bpp24 == bpp24 &&
+            ls->dx_start == dx_start && ls->dx_end == dx_end && ls->dmw == dmw && ls->fb_x == fb_x)
+      {
+         dest[0] = ls->edge[0];
+         dest[1] = ls->edge[1];
+         ScanoutSkipped++;
+         return;
+      }
+   }
+
+   {
+      ScanoutPixel *out = (ScanoutPixel *)dest;
+
+      memset(out, 0, dx_start * sizeof(ScanoutPixel));
+
+      //printf("%d %d %d - %d %d\n", scanline, dx_start, dx_end, HorizStart, HorizEnd);
+      ReorderRGB(bpp24, GPURAM[src_y], out, dx_start, dx_end, fb_x);
+
+      for(uint32 x = dx_end; x < dmw; x++)
+         out[x] = 0;
+   }
+
+   ScanoutConverted++;
+
+   if(ls)
+   {
+      ls->valid = (bool)(flags & SCANOUT_MAY_SKIP);
+      ls->bpp24 = bpp24;
+      ls->src_y = src_y;
+      ls->row_writes = RowWrites[src_y];
+      ls->dx_start = dx_start;
+      ls->dx_end = dx_end;
+      ls->dmw = dmw;
+      ls->fb_x = fb_x;
+      ls->edge[0] = dest[0];
+      ls->edge[1] = dest[1];
+   }
+}
+
+void PS_GPU::SetDupFrames(bool enabled)
+{
+   PS_GPU *g = SyncVRAM();	// MarkVRAMDirty() gets called on Renderer while there is one.
+
+   g->DupFrames = enabled;
+   DupFrames = enabled;
+   ScanoutReset = true;
+}
+
+bool PS_GPU::FrameUnchanged(void)
+{
+   PS_GPU *g = SyncVRAM();
+   const bool ret = !g->ScanoutConverted && g->ScanoutSkipped;
+
+   g->ScanoutConverted = 0;
+   g->ScanoutSkipped = 0;
+
+   return(ret);
+}
+
 pscpu_timestamp_t PS_GPU::Update(const pscpu_timestamp_t sys_timestamp)
 {
    static const uint32_t DotClockRatios[5] = { 10, 8, 5, 4, 7 };
@@ -1223,6 +1697,12 @@ pscpu_timestamp_t PS_GPU::Update(const pscpu_timestamp_t sys_timestamp)
    int32 sys_clocks = sys_timestamp - lastts;
    int32 gpu_clocks;
 
+   if(MDFN_UNLIKELY(RecFile != NULL))
+   {
+      RecBuf.push_back(REC_UPDATE);
+      RecPutTS(sys_timestamp);
+   }
+
    //printf("GPUISH: %d\n", sys_timestamp - lastts);
 
    if(!sys_clocks)
@@ -1355,6 +1835,7 @@ pscpu_timestamp_t PS_GPU::Update(const pscpu_timestamp_t sys_timestamp)
                      char buffer[256];
 
                      trio_snprintf(buffer, sizeof(buffer), _("VIDEO STANDARD MISMATCH"));
+                     ScanoutReset = true;
                      //DrawTextTrans(surface->pixels + ((DisplayRect->h / 2) - (13 / 2)) * surface->pitch32, surface->pitch32 << 2, DisplayRect->w, (UTF8*)buffer,
                      //surface->MakeColor(0x00, 0xFF, 0x00), true, MDFN_FONT_6x13_12x13);
                   }
@@ -1363,6 +1844,10 @@ pscpu_timestamp_t PS_GPU::Update(const pscpu_timestamp_t sys_timestamp)
                      espec->InterlaceOn = (bool)(DisplayMode & 0x20);
                      espec->InterlaceField = (bool)(DisplayMode & 0x20) && field;
 
+                     // The deinterlacer rewrites the lines of the other field.
+                     if(espec->InterlaceOn)
+                        ScanoutReset = true;
+
                      DisplayRect->x = 0;
                      DisplayRect->y = 0;
                      DisplayRect->w = 0;
@@ -1477,17 +1962,27 @@ pscpu_timestamp_t PS_GPU::Update(const pscpu_timestamp_t sys_timestamp)
 
                LineWidths[dest_line] = dmw;
 
+               // Lightguns look at(and draw crosshairs into) the line in PSX_GPULineHook() below, so it has to be there already for them;
+               // otherwise, leave it to the render thread to do in order with the drawing commands.  Frames that are skipped don't
+               // need it at all, unless they're interlaced, in which case the next frame is woven with this one's field.
+               if(!espec->skip || espec->InterlaceOn || PSX_GPULineHookReadsPixels())
                {
-                  uint32_t x;
-                  const uint16_t *src = GPURAM[DisplayFB_CurLineYReadout];
+                  const bool hook_reads = PSX_GPULineHookReadsPixels();
+                  uint32 flags = 0;
 
-                  memset(dest, 0, dx_start * sizeof(int32));
+                  if(DupFrames && !hook_reads && !espec->InterlaceOn)
+                     flags |= SCANOUT_MAY_SKIP;
 
-                  //printf("%d %d %d - %d %d\n", scanline, dx_start, dx_end, HorizStart, HorizEnd);
-                  ReorderRGB_Var(RED_SHIFT, GREEN_SHIFT, BLUE_SHIFT, DisplayMode & 0x10, src, dest, dx_start, dx_end, fb_x);
+                  if(ScanoutReset)
+                  {
+                     flags |= SCANOUT_RESET;
+                     ScanoutReset = false;
+                  }
 
-                  for(x = dx_end; x < dmw; x++)
-                     dest[x] = 0;
+                  if(Renderer && !hook_reads)
+                     RT_PushScanout(dest, dest_line, DisplayFB_CurLineYReadout, DisplayMode & 0x10, dx_start, dx_end, dmw, fb_x, flags);
+                  else
+                     SyncVRAM()->ScanoutLine(dest, dest_line, DisplayFB_CurLineYReadout, DisplayMode & 0x10, dx_start, dx_end, dmw, fb_x, flags);
                }
 
                //if(scanline == 64)
@@ -1529,10 +2024,19 @@ TheEnd:
 
 void PS_GPU::StartFrame(EmulateSpecStruct *espec_arg)
 {
+   if(MDFN_UNLIKELY(RecFile != NULL))
+   {
+      RecBuf.push_back(REC_START_FRAME);
+      RecPutVar(espec_arg->skip);
+   }
+
    sl_zero_reached = false;
 
    espec = espec_arg;
 
+   if(surface != espec->surface)
+      ScanoutReset = true;
+
    surface = espec->surface;
    DisplayRect = &espec->DisplayRect;
    LineWidths = espec->LineWidths;
@@ -28,6 +28,7 @@ struct tri_vertex
 
 struct i_group;
 struct i_deltas;
+struct tri_spans;
 
 struct line_point
 {
@@ -35,6 +36,13 @@ struct line_point
  uint8 r, g, b;
 };
 
+// Surface pixels as PS_GPU writes them; 16bpp builds pack two to each 32-bit pixel of the surface(see gpu_scanout.inc).
+#ifdef WANT_16BPP
+typedef uint16 ScanoutPixel;
+#else
+typedef uint32 ScanoutPixel;
+#endif
+
 class PS_GPU
 {
  public:
@@ -88,17 +96,135 @@ class PS_GPU
 
  INLINE uint16 PeekRAM(uint32 A)
  {
-  return(GPURAM[(A >> 10) & 0x1FF][A & 0x3FF]);
+  CatchUpVRAM();
+
+  return(SyncVRAM()->GPURAM[(A >> 10) & 0x1FF][A & 0x3FF]);
  }
 
  INLINE void PokeRAM(uint32 A, uint16 V)
  {
-  GPURAM[(A >> 10) & 0x1FF][A & 0x3FF] = V;
+  if(MDFN_UNLIKELY(RecFile != NULL))
+   RecordPoke(A, V);
+
+  PS_GPU *g = SyncVRAM();
+
+  g->SkipCatchUp();
+
+  g->GPURAM[(A >> 10) & 0x1FF][A & 0x3FF] = V;
+  g->MarkVRAMDirty(A & 0x3FF, (A >> 10) & 0x1FF, 1, 1);
+ }
+
+ // Rasterize on a separate thread(see gpu_async.inc); has no effect if the core was built without threading support.
+ void SetAsyncRender(bool enabled) MDFN_COLD;
+
+ // Wait for the render thread to finish all commands sent to it so far(must be done before the frame's surface is used).
+ void SyncRender(void);
+
+ // Split large primitives into bands of rows drawn by this many threads(see gpu_bands.inc); 1 to draw everything on the calling thread.
+ void SetBandThreads(unsigned count) MDFN_COLD;
+
+ // Draw polygon spans and convert display lines with SSE2/SSSE3/AVX2 kernels where the CPU supports them(see gpu_simd.inc and
+ // gpu_scanout.inc).
+ void SetSpanSIMD(bool enabled) MDFN_COLD;
+
+#ifdef PSX_SCANOUT_BENCHMARK
+ // Times each display line converter the CPU supports against the scalar one, for 15bpp and 24bpp lines.
+ void ScanoutBenchmark(int64 (*get_time_usec)(void), void (*report)(const char *mode, const char *kernel, double ns_per_pixel, bool matches)) MDFN_COLD;
+#endif
+
+ // Keep up to this many decoded 4bpp/8bpp texture pages(see gpu_texcache.inc); 0 to read texels from GPURAM every time.
+ void SetTexCacheSize(unsigned entries) MDFN_COLD;
+
+ struct TexCacheStats
+ {
+  uint64 hits;		// Textured primitives that found their page decoded already.
+  uint64 misses;	// Textured primitives that had to start a new page.
+  uint64 evictions;	// Misses that replaced a page still valid.
+  uint64 invalidations;	// Pages dropped because GPURAM they were decoded from was written to.
+  unsigned entries;
+ };
+
+ void GetTexCacheStats(TexCacheStats *stats) MDFN_COLD;
+
+ // Don't convert display lines whose parameters and GPURAM row are the same as the last time they were scanned out, since the
+ // surface holds them already.
+ void SetDupFrames(bool enabled) MDFN_COLD;
+
+ // Whether every line scanned out since the last call was skipped as unchanged; the frame's surface is then the same as the last one.
+ bool FrameUnchanged(void);
+
+ // Only run drawing commands for timing from now on(until called with false), and draw them later only if GPURAM they would have
+ // drawn to is read or displayed before being drawn over(see gpu_frameskip.inc).  Display lines aren't scanned out for frames whose
+ // EmulateSpecStruct has skip set.
+ void SetSkipDraw(bool skip);
+
+ // Draw whatever has been put off by SetSkipDraw().
+ void CatchUpVRAM(void);
+
+ struct SkipDrawStats
+ {
+  uint64 deferred;	// Drawing commands put off.
+  uint64 dropped;	// Put off and then drawn over before anything needed them.
+  uint64 drawn;		// Put off, but needed later after all.
+ };
+
+ void GetSkipDrawStats(SkipDrawStats *stats) MDFN_COLD;
+
+ int StateAction(StateMem *sm, int load, int data_only) MDFN_COLD;
+
+ //
+ // Command stream recording, for tools/gpu_replay.cpp(see gpu_record.inc).  A recording is "PSXGPURC", then(little-endian) uint32
+ // REC_VERSION, uint8 PAL, uint8 dithering, int16 first and last visible lines, uint32 length of the StateAction() snapshot that
+ // follows; then events until the end of the file, each a REC_* byte and its arguments.  Arguments are LEB128 varints, with timestamps
+ // as the zigzag-encoded difference from the last timestamp recorded(ResetTS() zeroes it).
+ //
+ enum
+ {
+  REC_VERSION = 1,
+
+  REC_WRITE = 1,	// timestamp, A & 7, V
+  REC_READ,		// timestamp, A & 7, value returned
+  REC_WRITE_DMA,	// V
+  REC_READ_DMA,		// value returned
+  REC_UPDATE,		// timestamp
+  REC_RESET_TS,
+  REC_POWER,
+  REC_START_FRAME,	// espec->skip
+  REC_SKIP_DRAW,	// skip
+  REC_POKE,		// A, V
+  REC_FRAME_END		// HashVRAM(), as 8 bytes rather than a varint.
+ };
+
+ // Record from the next call on; the GPU state the recording starts from is saved first.
+ bool StartRecording(const char *path) MDFN_COLD;
+ void StopRecording(void) MDFN_COLD;
+
+ INLINE bool IsRecording(void)
+ {
+  return RecFile != NULL;
  }
 
+ // Call at the end of each frame, once SyncRender() is done.
+ void RecordFrameEnd(void);
+
+ // Of GPURAM as it stands(so without catching up on what frameskip has put off).
+ uint64 HashVRAM(void);
+
+ struct CommandStats
+ {
+  uint64 count;		// Commands run, not counting the second half of quads and further polyline segments.
+  uint64 pixels;	// Pixels they covered(after clipping), or wrote for CPU->VRAM transfers.
+  uint64 time;		// In get_time_ns() units; only counted with get_time_ns set.
+ };
+
+ // Accumulate into stats[256], indexed by command byte, for commands as they're drawn; NULL to stop.
+ void SetCommandStats(CommandStats *stats, uint64 (*get_time_ns)(void)) MDFN_COLD;
+
  private:
 
  void ProcessFIFO(void);
+ void ExecuteCommand(const uint32 *CB);
+ void FBWriteUnit(uint32 InData);
  void WriteCB(uint32 data);
  uint32 ReadData(void);
  void SoftReset(void);
@@ -172,11 +298,20 @@ class PS_GPU
  uint16 ModTexel(uint16 texel, int32 r, int32 g, int32 b, const int32 dither_x, const int32 dither_y);
 
  template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode, bool MaskEval_TA>
- void DrawSpan(int y, uint32 clut_offset, const int32 x_start, const int32 x_bound, i_group ig, const i_deltas &idl);
+ void DrawSpan(int y, uint32 clut_offset, const int32 x_start, const int32 x_bound, i_group ig, const i_deltas &idl, const bool timing, const bool pixels);
+
+ template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
+ void DrawTriangleSpans(const tri_spans &ts, int32 y0, int32 y1, const bool timing, const bool pixels);
+
+ template<bool goraud, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
+ void DrawTriangleBand(const void *arg, int32 y0, int32 y1);
 
  template<bool shaded, bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA>
  void DrawTriangle(tri_vertex *vertices, uint32 clut);
 
+ template<bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA, bool FlipX, bool FlipY>
+ void DrawSpriteRows(const void *arg, int32 y0, int32 y1);
+
  template<bool textured, int BlendMode, bool TexMult, uint32 TexMode_TA, bool MaskEval_TA, bool FlipX, bool FlipY>
  void DrawSprite(int32 x_arg, int32 y_arg, int32 w, int32 h, uint8 u_arg, uint8 v_arg, uint32 color, uint32 clut_offset);
 
@@ -198,7 +333,9 @@ class PS_GPU
  void Command_IRQ(const uint32 *cb);
 
  void Command_FBFill(const uint32 *cb);
+ void FBFillRows(const void *arg, int32 y0, int32 y1);
  void Command_FBCopy(const uint32 *cb);
+ void FBCopyRows(const void *arg, int32 y0, int32 y1);
  void Command_FBWrite(const uint32 *cb);
  void Command_FBRead(const uint32 *cb);
 
@@ -303,10 +440,176 @@ class PS_GPU
  bool HardwarePALType;
  int LineVisFirst, LineVisLast;
 
- void ReorderRGB_Var(uint32 out_Rshift, uint32 out_Gshift, uint32 out_Bshift, bool bpp24, const uint16 *src, uint32 *dest, const int32 dx_start, const int32 dx_end, int32 fb_x);
+ void ReorderRGB_Var(bool bpp24, const uint16 *src, ScanoutPixel *dest, const int32 dx_start, const int32 dx_end, int32 fb_x);
+ void ReorderRGB(bool bpp24, const uint16 *src, ScanoutPixel *dest, int32 dx_start, const int32 dx_end, int32 fb_x);
+
+ enum
+ {
+  SCANOUT_MAY_SKIP = 1 << 0,	// The line can be left as it is if unchanged; otherwise remember it as it wasn't converted.
+  SCANOUT_RESET = 1 << 1	// Forget every line converted before this one.
+ };
+
+ void ScanoutLine(uint32 *dest, uint32 dest_line, uint32 src_y, bool bpp24, int32 dx_start, int32 dx_end, uint32 dmw, int32 fb_x, uint32 flags);
+
+ //
+ // Duplicate line/frame detection.  RowWrites[] counts primitives and transfers that may have written to each GPURAM row, and
+ // ScanoutLines[] records what each line of the surface was last converted from.
+ //
+ struct ScanoutLineState
+ {
+  bool valid;
+  bool bpp24;
+  uint32 src_y;
+  uint32 row_writes;
+  int32 dx_start, dx_end;
+  uint32 dmw;
+  int32 fb_x;
+  uint32 edge[2];	// dest[0] and dest[1], which get cleared at the start of each frame.
+ };
+
+ bool DupFrames;
+ bool ScanoutReset;	// Pass SCANOUT_RESET with the next line.
+ uint32 RowWrites[512];
+ ScanoutLineState ScanoutLines[576];
+ uint32 ScanoutConverted;
+ uint32 ScanoutSkipped;
+
+ // Called for everything written to GPURAM, for the texture cache and duplicate line detection.
+ void MarkVRAMDirty(int32 x, int32 y, int32 w, int32 h);
+
+ //
+ // Asynchronous rendering.  While enabled, this object still runs every command(so DrawTimeAvail, InCmd etc. stay exact), but
+ // with DrawTimingOnly set, and forwards them through RT_Ring to Renderer; the render thread runs them again on Renderer,
+ // which holds the GPURAM contents that count.
+ //
+ enum
+ {
+  RT_CMD_NEW = 1,	// [env][command words], a command from the start.
+  RT_CMD_CONT,		// [env][command words], the next vertices of the quad or polyline in progress.
+  RT_FBWRITE,		// [data], for a CPU->VRAM transfer in progress.
+  RT_SCANOUT,		// See RT_PushScanout()
+  RT_SKIP_DRAW,		// [skip], for SetSkipDraw().
+  RT_QUIT
+ };
+
+ PS_GPU *SyncVRAM(void);
+
+ void RT_Push(const uint32 *words, uint32 count);
+ void RT_PushCommand(uint32 type, const uint32 *CB, uint32 len);
+ void RT_PushFBWrite(uint32 InData);
+ void RT_PushScanout(uint32 *dest, uint32 dest_line, uint32 src_y, bool bpp24, int32 dx_start, int32 dx_end, uint32 dmw, int32 fb_x, uint32 flags);
+ void RT_Execute(const uint32 *ent);
+
+ public:
+ int RenderThreadStart(void);	// Render-thread-only.
+ private:
+
+ PS_GPU *Renderer;
+ bool DrawTimingOnly;
+
+ uint32 *RT_Ring;
+ uint32 RT_WritePos;
+ uint32 RT_ReadPos;
+
+#ifdef WANT_THREADING
+ MDFN_Thread *RenderThread;
+#endif
+
+ //
+ // Band-parallel rasterization.
+ //
+ typedef void (PS_GPU::*BandFunc)(const void *arg, int32 y0, int32 y1);
+
+ struct BandPool;
+ BandPool *Bands;	// Shared with Renderer, which is the one that uses it while async rendering is enabled.
+
+ bool UseBands(int32 rows, int32 pixels);
+ void RunBands(BandFunc func, const void *arg, int32 y_start, int32 y_bound);
+
+ template<uint32 TexMode_TA>
+ bool TexReadsOverlap(uint32 clut_offset, int32 x, int32 y, int32 w, int32 h);
+
+ //
+ // Decoded texture page cache.
+ //
+ struct TexCacheEntry;
+ TexCacheEntry *TexCache;	// Moves to Renderer while async rendering is enabled.
+ unsigned TexCacheCount;
+ TexCacheEntry *TexCur;		// For the primitive being drawn, or NULL.
+ uint32 TexCacheClock;
+ uint32 TexDirty[(1024 / 64) * (512 / 32) / 32];
+ TexCacheStats TexStats;
+
+ template<uint32 TexMode_TA>
+ void TexCacheSelect(uint32 clut, int32 x, int32 y, int32 w, int32 h);
+
+ template<uint32 TexMode_TA>
+ void TexCacheDecodeRow(TexCacheEntry *e, uint32 v);
+
+ void TexCacheFree(void);
+
+ //
+ // Frameskip.  While SkipDraw is set, drawing commands are only run for timing, and kept in SkipLog(RT_Ring entries, with the index of
+ // the SkipRect for the command's drawing area in bits 16 and up of the header word) in case they turn out to be needed.
+ //
+ enum { SKIP_MAX_RECTS = 8 };
+
+ struct SkipRect
+ {
+  bool used;
+  int32 x0, y0, x1, y1;	// Inclusive.
+  uint32 reads[(1024 / 64) * (512 / 32) / 32];	// Blocks of GPURAM(as in TexDirty) that textures and CLUTs are read from.
+ };
+
+ bool SkipDraw;
+ bool SkipCmdLogged;	// For the quad or polyline in progress.
+ uint32 SkipCmdRect;
+ std::vector<uint32> SkipLog;
+ uint32 SkipLogEnv[6];	// Drawing environment as of the last entry, as commands 0xE1 through 0xE6.
+ SkipRect SkipRects[SKIP_MAX_RECTS];
+ SkipDrawStats SkipStats;
+
+ void RunCommand(uint32 type, const uint32 *CB, uint32 len);
+ void GetDrawEnv(uint32 *env);
+ unsigned GetTexAreas(const uint32 *CB, int32 (*areas)[4]);
+ void SkipLogCommand(uint32 type, const uint32 *CB, uint32 len);
+ void SkipWrite(int32 x, int32 y, int32 w, int32 h, bool covers);
+ void SkipRead(int32 x, int32 y, int32 w, int32 h);
+ void SkipCatchUp(void);
+ void SkipClear(void);
+
+ //
+ // Recording and command statistics.  Renderer gets neither RecFile nor RecBuf, since recording is done on this side.
+ //
+ FILE *RecFile;
+ std::vector<uint8> RecBuf;	// Written out at the end of each frame.
+ pscpu_timestamp_t RecLastTS;
+
+ INLINE void RecPutVar(uint32 v)
+ {
+  while(v >= 0x80)
+  {
+   RecBuf.push_back((v & 0x7F) | 0x80);
+   v >>= 7;
+  }
+  RecBuf.push_back(v);
+ }
+
+ INLINE void RecPutTS(pscpu_timestamp_t timestamp)
+ {
+  const int32 delta = timestamp - RecLastTS;
+
+  RecLastTS = timestamp;
+  RecPutVar(((uint32)delta << 1) ^ (uint32)(delta >> 31));
+ }
+
+ void RecordPoke(uint32 A, uint16 V);
+
+ CommandStats *CmdStats;
+ uint64 (*CmdStatsTime)(void);
+ uint64 DrawnPixels;
 
- template<uint32 out_Rshift, uint32 out_Gshift, uint32 out_Bshift>
- void ReorderRGB(bool bpp24, const uint16 *src, uint32 *dest, const int32 dx_start, const int32 dx_end, int32 fb_x) NO_INLINE;
+ void RunCommandStats(uint32 type, const uint32 *CB, uint32 cc);
 };
 
 }
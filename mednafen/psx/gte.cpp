@@ -20,6 +20,11 @@
 
 #include "../clamp.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+ #define GTE_HAVE_X86_SIMD 1
+ #include <immintrin.h>
+#endif
+
 static uint32_t ReciprocalTable[0x8000] =
 {
  #include "gte_divrecip.inc"
@@ -75,18 +80,18 @@ typedef struct
    int16_t Y;
 } gtexy;
 
-int16_t Lm_B(unsigned int which, int32_t value, int lm);
-uint8_t Lm_C(unsigned int which, int32_t value);
+template<bool Flags> int16_t Lm_B(unsigned int which, int32_t value, int lm);
+template<bool Flags> uint8_t Lm_C(unsigned int which, int32_t value);
 
 
 
-int32_t Lm_G(unsigned int which, int32_t value);
-int32_t Lm_H(int32_t value);
+template<bool Flags> int32_t Lm_G(unsigned int which, int32_t value);
+template<bool Flags> int32_t Lm_H(int32_t value);
 
-void MAC_to_RGB_FIFO(void);
-void MAC_to_IR(int lm);
+template<bool Flags> void MAC_to_RGB_FIFO(void);
+template<bool Flags> void MAC_to_IR(int lm);
 
-void MultiplyMatrixByVector(const gtematrix *matrix, const int16_t *v, const int32_t *crv, uint32_t sf, int lm);
+template<bool Flags> void MultiplyMatrixByVector(const gtematrix *matrix, const int16_t *v, const int32_t *crv, uint32_t sf, int lm);
 
 static uint32_t CR[32];
 static uint32_t FLAGS;	// Temporary for instruction execution, copied into CR[31] at end of instruction execution.
@@ -153,40 +158,151 @@ static uint32_t LZCR;
 static uint32_t Reg23;
 // end DR
 
-int32_t RTPS(uint32_t instr);
-int32_t RTPT(uint32_t instr);
+//
+// Lazy FLAGS(see GTE_SetLazyFlags()): instructions run without computing FLAGS(beyond the F() bits Lm_D() depends on), and the
+// last one is run again with them, from a copy of its inputs, if CR 31 is read(or a save state made) before another instruction
+// replaces it.  Only the DR registers the instruction reads(LazyInputs[]) are copied before it runs; the CR registers are copied
+// on the first write to them afterwards, which is rare.
+//
+struct LazyDR
+{
+   int16_t Vectors[3][4];
+   gtergb RGB;
+   uint16_t OTZ;
+   int16_t IR[4];
+   gtexy XY_FIFO[4];
+   uint16_t Z_FIFO[4];
+   gtergb RGB_FIFO[3];
+   int32_t MAC[4];
+};
+
+struct LazyCR
+{
+   uint32_t CR[32];
+   Matrices_t Matrices;
+   int32_t CRVectors[4][4];
+   int32_t OFX;
+   int32_t OFY;
+   uint16_t H;
+   int16_t DQA;
+   int32_t DQB;
+   int16_t ZSF3;
+   int16_t ZSF4;
+};
+
+// Groups of DR registers in LazyDR.
+enum
+{
+   LAZY_V = 0x01,		// Vectors
+   LAZY_RGB = 0x02,
+   LAZY_IR = 0x04,		// IR0-IR3
+   LAZY_XY = 0x08,		// XY_FIFO
+   LAZY_Z = 0x10,		// Z_FIFO
+   LAZY_RGB_FIFO = 0x20,
+   LAZY_MAC = 0x40,
+   LAZY_OTZ = 0x80,		// Never read by an instruction.
+
+   LAZY_ALL = 0xFF
+};
+
+// The DR registers each instruction reads, by opcode.
+static const uint8_t LazyInputs[0x40] =
+{
+   /* 0x00 */ LAZY_V, LAZY_V, 0, 0, 0, 0, LAZY_XY, 0,
+   /* 0x08 */ 0, 0, 0, 0, LAZY_IR, 0, 0, 0,
+   /* 0x10 */ LAZY_RGB | LAZY_IR, LAZY_IR, LAZY_V | LAZY_RGB | LAZY_IR, LAZY_V | LAZY_RGB | LAZY_IR, LAZY_RGB | LAZY_IR, 0, LAZY_V | LAZY_RGB | LAZY_IR, 0,
+   /* 0x18 */ 0, 0, LAZY_RGB | LAZY_IR, LAZY_V | LAZY_RGB, LAZY_RGB | LAZY_IR, 0, LAZY_V, 0,
+   /* 0x20 */ LAZY_V, 0, 0, 0, 0, 0, 0, 0,
+   /* 0x28 */ LAZY_IR, LAZY_RGB | LAZY_IR, LAZY_RGB_FIFO | LAZY_IR, 0, 0, LAZY_Z, LAZY_Z, 0,
+   /* 0x30 */ LAZY_V, 0, 0, 0, 0, 0, 0, 0,
+   /* 0x38 */ 0, 0, 0, 0, 0, LAZY_IR, LAZY_IR | LAZY_MAC, LAZY_V | LAZY_RGB,
+};
+
+static bool LazyFlags;
 
-int32_t NCLIP(uint32_t instr);
+static struct
+{
+   bool Pending;
+   bool HaveCR;
+   uint8_t inputs;	// LazyInputs[] of instr
+   uint32_t instr;
+
+   LazyDR DR;
+   LazyCR CR;
+} Lazy;
+
+#define LAZY_COPY(r) { if(save) memcpy(&s->r, &r, sizeof(r)); else memcpy(&r, &s->r, sizeof(r)); }
+static INLINE void LazyDR_Copy(LazyDR *s, bool save, unsigned which)
+{
+   if(which & LAZY_V)
+      LAZY_COPY(Vectors);
+   if(which & LAZY_RGB)
+      LAZY_COPY(RGB);
+   if(which & LAZY_OTZ)
+      LAZY_COPY(OTZ);
+   if(which & LAZY_IR)
+      LAZY_COPY(IR);
+   if(which & LAZY_XY)
+      LAZY_COPY(XY_FIFO);
+   if(which & LAZY_Z)
+      LAZY_COPY(Z_FIFO);
+   if(which & LAZY_RGB_FIFO)
+      LAZY_COPY(RGB_FIFO);
+   if(which & LAZY_MAC)
+      LAZY_COPY(MAC);
+}
+
+static void LazyCR_Copy(LazyCR *s, bool save)
+{
+   LAZY_COPY(CR);
+   LAZY_COPY(Matrices);
+   LAZY_COPY(CRVectors);
+   LAZY_COPY(OFX);
+   LAZY_COPY(OFY);
+   LAZY_COPY(H);
+   LAZY_COPY(DQA);
+   LAZY_COPY(DQB);
+   LAZY_COPY(ZSF3);
+   LAZY_COPY(ZSF4);
+}
+#undef LAZY_COPY
+
+static void LazyFlags_Resolve(void);
+
+template<bool Flags, uint32_t sf, int lm> int32_t RTPS(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t RTPT(uint32_t instr);
+
+template<bool Flags, uint32_t sf, int lm> int32_t NCLIP(uint32_t instr);
 
-void NormColor(uint32_t sf, int lm, uint32_t v);
-int32_t NCS(uint32_t instr);
-int32_t NCT(uint32_t instr);
+template<bool Flags> void NormColor(uint32_t sf, int lm, uint32_t v);
+template<bool Flags, uint32_t sf, int lm> int32_t NCS(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t NCT(uint32_t instr);
 
 
-void NormColorColor(uint32_t v, uint32_t sf, int lm);
-int32_t NCCS(uint32_t instr);
-int32_t NCCT(uint32_t instr);
+template<bool Flags> void NormColorColor(uint32_t v, uint32_t sf, int lm);
+template<bool Flags, uint32_t sf, int lm> int32_t NCCS(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t NCCT(uint32_t instr);
 
-void NormColorDepthCue(uint32_t v, uint32_t sf, int lm);
-int32_t NCDS(uint32_t instr);
-int32_t NCDT(uint32_t instr);
+template<bool Flags> void NormColorDepthCue(uint32_t v, uint32_t sf, int lm);
+template<bool Flags, uint32_t sf, int lm> int32_t NCDS(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t NCDT(uint32_t instr);
 
-int32_t AVSZ3(uint32_t instr);
-int32_t AVSZ4(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t AVSZ3(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t AVSZ4(uint32_t instr);
 
-int32_t OP(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t OP(uint32_t instr);
 
-int32_t GPF(uint32_t instr);
-int32_t GPL(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t GPF(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t GPL(uint32_t instr);
 
-void DepthCue(int mult_IR123, int RGB_from_FIFO, uint32_t sf, int lm);
-int32_t DCPL(uint32_t instr);
-int32_t DPCS(uint32_t instr);
-int32_t DPCT(uint32_t instr);
-int32_t INTPL(uint32_t instr);
+template<bool Flags> void DepthCue(int mult_IR123, int RGB_from_FIFO, uint32_t sf, int lm);
+template<bool Flags, uint32_t sf, int lm> int32_t DCPL(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t DPCS(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t DPCT(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t INTPL(uint32_t instr);
 
-int32_t SQR(uint32_t instr);
-int32_t MVMVA(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm> int32_t SQR(uint32_t instr);
+template<bool Flags, uint32_t sf, int lm, uint32_t mx, uint32_t v_i, uint32_t cv_i> int32_t MVMVA(uint32_t instr);
 
 static INLINE uint8_t Sat5(int16_t cc)
 {
@@ -229,6 +345,8 @@ void GTE_Power(void)
    LZCR = 0;
 
    Reg23 = 0;
+
+   Lazy.Pending = false;
 }
 
 // TODO: Don't save redundant state, regarding CR cache variables
@@ -280,11 +398,16 @@ int GTE_StateAction(StateMem *sm, int load, int data_only)
 
       SFEND
    };
-   int ret = MDFNSS_StateAction(sm, load, data_only, StateRegs, "GTE");
+   int ret;
+
+   if(!load)
+      LazyFlags_Resolve();
+
+   ret = MDFNSS_StateAction(sm, load, data_only, StateRegs, "GTE");
 
    if(load)
    {
-
+      Lazy.Pending = false;
    }
 
    return(ret);
@@ -309,6 +432,17 @@ void GTE_WriteCR(unsigned int which, uint32_t value)
 
    //PSX_WARNING("[GTE] Write CR %d, 0x%08x", which, value);
 
+   if(Lazy.Pending)
+   {
+      if(which == 31)
+         Lazy.Pending = false;
+      else if(!Lazy.HaveCR)
+      {
+         LazyCR_Copy(&Lazy.CR, true);
+         Lazy.HaveCR = true;
+      }
+   }
+
    value &= mask_table[which];
 
    CR[which] = value | (CR[which] & ~mask_table[which]);
@@ -408,6 +542,7 @@ uint32_t GTE_ReadCR(unsigned int which)
          break;
 
       case 31:
+         LazyFlags_Resolve();
          ret = CR[31];
          break;
    }
@@ -720,12 +855,13 @@ uint32_t GTE_ReadDR(unsigned int which)
 
 #define sign_x_to_s64(_bits, _value) (((int64)((uint64)(_value) << (64 - _bits))) >> (64 - _bits))
 
+template<bool Flags>
 INLINE int64_t A_MV(unsigned which, int64_t value)
 {
-   if(value >= (1LL << 43))
+   if(Flags && value >= (1LL << 43))
       FLAGS |= 1 << (30 - which);
 
-   if(value < -(1LL << 43))
+   if(Flags && value < -(1LL << 43))
       FLAGS |= 1 << (27 - which);
 
    return sign_x_to_s64(44, value);
@@ -748,6 +884,7 @@ INLINE int64_t F(int64_t value)
 }
 
 
+template<bool Flags>
 INLINE int16_t Lm_B(unsigned int which, int32_t value, int lm)
 {
    int32_t tmp = lm << 15;
@@ -755,28 +892,29 @@ INLINE int16_t Lm_B(unsigned int which, int32_t value, int lm)
    if(value < (-32768 + tmp))
    {
       // set flag here
-      FLAGS |= 1 << (24 - which);
+      if(Flags) FLAGS |= 1 << (24 - which);
       value = -32768 + tmp;
    }
 
    if(value > 32767)
    {
       // Set flag here
-      FLAGS |= 1 << (24 - which);
+      if(Flags) FLAGS |= 1 << (24 - which);
       value = 32767;
    }
 
    return(value);
 }
 
+template<bool Flags>
 INLINE int16_t Lm_B_PTZ(unsigned int which, int32_t value, int32_t ftv_value, int lm)
 {
    int32_t tmp = lm << 15;
 
-   if(ftv_value < -32768)
+   if(Flags && ftv_value < -32768)
       FLAGS |= 1 << (24 - which);
 
-   if(ftv_value > 32767)
+   if(Flags && ftv_value > 32767)
       FLAGS |= 1 << (24 - which);
 
    clamp(&value, (-32768 + tmp), 32767);
@@ -784,12 +922,13 @@ INLINE int16_t Lm_B_PTZ(unsigned int which, int32_t value, int32_t ftv_value, in
    return(value);
 }
 
+template<bool Flags>
 INLINE uint8_t Lm_C(unsigned int which, int32_t value)
 {
    if(value & ~0xFF)
    {
       // Set flag here
-      FLAGS |= 1 << (21 - which);	// Tested with GPF
+      if(Flags) FLAGS |= 1 << (21 - which);	// Tested with GPF
 
       if(value < 0)
          value = 0;
@@ -801,6 +940,7 @@ INLINE uint8_t Lm_C(unsigned int which, int32_t value)
    return(value);
 }
 
+template<bool Flags>
 INLINE int32_t Lm_D(int32_t value, int unchained)
 {
    // Not sure if we should have it as int64, or just chain on to and special case when the F flags are set.
@@ -808,13 +948,13 @@ INLINE int32_t Lm_D(int32_t value, int unchained)
    {
       if(FLAGS & (1 << 15))
       {
-         FLAGS |= 1 << 18;
+         if(Flags) FLAGS |= 1 << 18;
          return(0);
       }
 
       if(FLAGS & (1 << 16))
       {
-         FLAGS |= 1 << 18;
+         if(Flags) FLAGS |= 1 << 18;
          return(0xFFFF);
       }
    }
@@ -823,38 +963,40 @@ INLINE int32_t Lm_D(int32_t value, int unchained)
    {
       // Set flag here
       value = 0;
-      FLAGS |= 1 << 18;	// Tested with AVSZ3
+      if(Flags) FLAGS |= 1 << 18;	// Tested with AVSZ3
    }
    else if(value > 65535)
    {
       // Set flag here.
       value = 65535;
-      FLAGS |= 1 << 18;	// Tested with AVSZ3
+      if(Flags) FLAGS |= 1 << 18;	// Tested with AVSZ3
    }
 
    return(value);
 }
 
+template<bool Flags>
 INLINE int32_t Lm_G(unsigned int which, int32_t value)
 {
    if(value < -1024)
    {
       // Set flag here
       value = -1024;
-      FLAGS |= 1 << (14 - which);
+      if(Flags) FLAGS |= 1 << (14 - which);
    }
 
    if(value > 1023)
    {
       // Set flag here.
       value = 1023;
-      FLAGS |= 1 << (14 - which);
+      if(Flags) FLAGS |= 1 << (14 - which);
    }
 
    return(value);
 }
 
 // limit to 4096, not 4095
+template<bool Flags>
 INLINE int32_t Lm_H(int32_t value)
 {
 #if 0
@@ -876,40 +1018,197 @@ INLINE int32_t Lm_H(int32_t value)
    if(value < 0)
    {
       value = 0;
-      FLAGS |= 1 << 12;
+      if(Flags) FLAGS |= 1 << 12;
    }
 
    if(value > 4096)
    {
       value = 4096;
-      FLAGS |= 1 << 12;
+      if(Flags) FLAGS |= 1 << 12;
    }
 
    return(value);
 }
 
+template<bool Flags>
 INLINE void MAC_to_RGB_FIFO(void)
 {
    RGB_FIFO[0] = RGB_FIFO[1];
    RGB_FIFO[1] = RGB_FIFO[2];
-   RGB_FIFO[2].R = Lm_C(0, MAC[1] >> 4);
-   RGB_FIFO[2].G = Lm_C(1, MAC[2] >> 4);
-   RGB_FIFO[2].B = Lm_C(2, MAC[3] >> 4);
+   RGB_FIFO[2].R = Lm_C<Flags>(0, MAC[1] >> 4);
+   RGB_FIFO[2].G = Lm_C<Flags>(1, MAC[2] >> 4);
+   RGB_FIFO[2].B = Lm_C<Flags>(2, MAC[3] >> 4);
    RGB_FIFO[2].CD = RGB.CD;
 }
 
 
+template<bool Flags>
 INLINE void MAC_to_IR(int lm)
 {
-   IR1 = Lm_B(0, MAC[1], lm);
-   IR2 = Lm_B(1, MAC[2], lm);
-   IR3 = Lm_B(2, MAC[3], lm);
+   IR1 = Lm_B<Flags>(0, MAC[1], lm);
+   IR2 = Lm_B<Flags>(1, MAC[2], lm);
+   IR3 = Lm_B<Flags>(2, MAC[3], lm);
+}
+
+//
+// The matrix * vector part of MultiplyMatrixByVector*(), for the usual case(not the garbage matrix, nor the FC vector bug).
+// Leaves the sign_x_to_s64(44, ...) sums of the three rows in tmp[0..2](tmp[3] is scratch), and returns the A_MV() flag bits;
+// crv must point into CRVectors.All[].
+//
+typedef uint32_t (*MatrixVectorFunc)(const gtematrix *matrix, const int16_t *v, const int32_t *crv, int64_t *tmp);
+
+static uint32_t MatrixVector_Scalar(const gtematrix *matrix, const int16_t *v, const int32_t *crv, int64_t *tmp)
+{
+   uint32_t flags = 0;
+
+   for(unsigned i = 0; i < 3; i++)
+   {
+      tmp[i] = (int64)crv[i] << 12;
+
+      for(unsigned j = 0; j < 3; j++)
+      {
+         tmp[i] += matrix->MX[i][j] * v[j];
+
+         if(tmp[i] >= (1LL << 43))
+            flags |= 1 << (30 - i);
+
+         if(tmp[i] < -(1LL << 43))
+            flags |= 1 << (27 - i);
+
+         tmp[i] = sign_x_to_s64(44, tmp[i]);
+      }
+   }
+
+   return(flags);
+}
+
+#ifdef GTE_HAVE_X86_SIMD
+//
+// One row per 64-bit lane.  Overflow is checked on the upper 32 bits of each sum(>= 1 << 43 is > 2047 there, < -(1 << 43)
+// is < -2048), which works with plain SSE2 compares, and sign extension from bit 43 is done as
+// ((x + (1 << 43)) & ((1 << 44) - 1)) - (1 << 43), for lack of 64-bit arithmetic shifts.
+//
+static const uint8_t MatrixVector_RowFlags[8] = { 0, 4, 2, 6, 1, 5, 3, 7 };	// Lane bits to (1 << (2 - row)) bits
+
+static INLINE uint32_t MatrixVector_Flags(int pos_lanes, int neg_lanes)
+{
+   return((MatrixVector_RowFlags[pos_lanes & 0x7] << 28) | (MatrixVector_RowFlags[neg_lanes & 0x7] << 25));
+}
+
+// Products of each matrix column with its vector element, as 32-bit { row 0, row 1, row 2, 0 }.  Column 2 comes from a second
+// load 2 bytes in, so as to not read past the dummy element.
+__attribute__((target("sse4.1"))) static INLINE void MatrixVector_Products(const gtematrix *matrix, const int16_t *v, __m128i *prod)
+{
+   const __m128i sel_odd = _mm_setr_epi8(2, 3, -1, -1, 8, 9, -1, -1, 14, 15, -1, -1, -1, -1, -1, -1);
+   const __m128i sel_even = _mm_setr_epi8(0, 1, -1, -1, 6, 7, -1, -1, 12, 13, -1, -1, -1, -1, -1, -1);
+   const __m128i m_lo = _mm_loadu_si128((const __m128i *)&matrix->MX[0][0]);
+   const __m128i m_hi = _mm_loadu_si128((const __m128i *)&matrix->MX[0][1]);
+
+   prod[0] = _mm_madd_epi16(_mm_shuffle_epi8(m_lo, sel_even), _mm_set1_epi16(v[0]));
+   prod[1] = _mm_madd_epi16(_mm_shuffle_epi8(m_lo, sel_odd), _mm_set1_epi16(v[1]));
+   prod[2] = _mm_madd_epi16(_mm_shuffle_epi8(m_hi, sel_odd), _mm_set1_epi16(v[2]));
+}
+
+__attribute__((target("sse4.1"))) static uint32_t MatrixVector_SSE41(const gtematrix *matrix, const int16_t *v, const int32_t *crv, int64_t *tmp)
+{
+   const __m128i bias = _mm_set1_epi64x(1LL << 43);
+   const __m128i mask = _mm_set1_epi64x((1LL << 44) - 1);
+   const __m128i crvs = _mm_loadu_si128((const __m128i *)crv);
+   __m128i acc01 = _mm_slli_epi64(_mm_cvtepi32_epi64(crvs), 12);
+   __m128i acc23 = _mm_slli_epi64(_mm_cvtepi32_epi64(_mm_unpackhi_epi64(crvs, crvs)), 12);
+   __m128i pos = _mm_setzero_si128();
+   __m128i neg = _mm_setzero_si128();
+   __m128i prod[3];
+
+   MatrixVector_Products(matrix, v, prod);
+
+   for(unsigned j = 0; j < 3; j++)
+   {
+      __m128i hi;
+
+      acc01 = _mm_add_epi64(acc01, _mm_cvtepi32_epi64(prod[j]));
+      acc23 = _mm_add_epi64(acc23, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(prod[j], prod[j])));
+
+      hi = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(acc01), _mm_castsi128_ps(acc23), _MM_SHUFFLE(3, 1, 3, 1)));
+      pos = _mm_or_si128(pos, _mm_cmpgt_epi32(hi, _mm_set1_epi32(2047)));
+      neg = _mm_or_si128(neg, _mm_cmplt_epi32(hi, _mm_set1_epi32(-2048)));
+
+      acc01 = _mm_sub_epi64(_mm_and_si128(_mm_add_epi64(acc01, bias), mask), bias);
+      acc23 = _mm_sub_epi64(_mm_and_si128(_mm_add_epi64(acc23, bias), mask), bias);
+   }
+
+   _mm_storeu_si128((__m128i *)&tmp[0], acc01);
+   _mm_storeu_si128((__m128i *)&tmp[2], acc23);
+
+   return(MatrixVector_Flags(_mm_movemask_ps(_mm_castsi128_ps(pos)), _mm_movemask_ps(_mm_castsi128_ps(neg))));
+}
+
+__attribute__((target("avx2"))) static uint32_t MatrixVector_AVX2(const gtematrix *matrix, const int16_t *v, const int32_t *crv, int64_t *tmp)
+{
+   const __m256i bias = _mm256_set1_epi64x(1LL << 43);
+   const __m256i mask = _mm256_set1_epi64x((1LL << 44) - 1);
+   const __m256i pos_limit = _mm256_set1_epi64x((1LL << 43) - 1);
+   const __m256i neg_limit = _mm256_set1_epi64x(-(1LL << 43));
+   __m256i acc = _mm256_slli_epi64(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)crv)), 12);
+   __m256i pos = _mm256_setzero_si256();
+   __m256i neg = _mm256_setzero_si256();
+   __m128i prod[3];
+
+   MatrixVector_Products(matrix, v, prod);
+
+   for(unsigned j = 0; j < 3; j++)
+   {
+      acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(prod[j]));
+
+      pos = _mm256_or_si256(pos, _mm256_cmpgt_epi64(acc, pos_limit));
+      neg = _mm256_or_si256(neg, _mm256_cmpgt_epi64(neg_limit, acc));
+
+      acc = _mm256_sub_epi64(_mm256_and_si256(_mm256_add_epi64(acc, bias), mask), bias);
+   }
+
+   _mm256_storeu_si256((__m256i *)tmp, acc);
+
+   return(MatrixVector_Flags(_mm256_movemask_pd(_mm256_castsi256_pd(pos)), _mm256_movemask_pd(_mm256_castsi256_pd(neg))));
+}
+#endif
+
+static MatrixVectorFunc MatrixVector = MatrixVector_Scalar;
+
+void GTE_Init(void)
+{
+   MatrixVector = MatrixVector_Scalar;
+
+#ifdef GTE_HAVE_X86_SIMD
+   __builtin_cpu_init();
+
+   if(__builtin_cpu_supports("avx2"))
+      MatrixVector = MatrixVector_AVX2;
+   else if(__builtin_cpu_supports("sse4.1"))
+      MatrixVector = MatrixVector_SSE41;
+#endif
 }
 
+template<bool Flags>
 INLINE void MultiplyMatrixByVector(const gtematrix *matrix, const int16_t *v, const int32_t *crv, uint32_t sf, int lm)
 {
    unsigned i;
 
+   if(matrix != &Matrices.AbbyNormal && crv != CRVectors.FC)
+   {
+      int64_t tmp[4];
+      const uint32_t mv_flags = MatrixVector(matrix, v, crv, tmp);
+
+      if(Flags)
+         FLAGS |= mv_flags;
+
+      MAC[1] = tmp[0] >> sf;
+      MAC[2] = tmp[1] >> sf;
+      MAC[3] = tmp[2] >> sf;
+
+      MAC_to_IR<Flags>(lm);
+      return;
+   }
+
    for(i = 0; i < 3; i++)
    {
       int64_t tmp;
@@ -942,102 +1241,120 @@ INLINE void MultiplyMatrixByVector(const gtematrix *matrix, const int16_t *v, co
       mulr[1] *= v[1];
       mulr[2] *= v[2];
 
-      tmp = A_MV(i, tmp + mulr[0]);
+      tmp = A_MV<Flags>(i, tmp + mulr[0]);
       if(crv == CRVectors.FC)
       {
-         Lm_B(i, tmp >> sf, FALSE);
+         Lm_B<Flags>(i, tmp >> sf, FALSE);
          tmp = 0;
       }
 
-      tmp = A_MV(i, tmp + mulr[1]);
-      tmp = A_MV(i, tmp + mulr[2]);
+      tmp = A_MV<Flags>(i, tmp + mulr[1]);
+      tmp = A_MV<Flags>(i, tmp + mulr[2]);
 
       MAC[1 + i] = tmp >> sf;
    }
 
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 }
 
 
+template<bool Flags>
 INLINE void MultiplyMatrixByVector_PT(const gtematrix *matrix, const int16_t *v, const int32_t *crv, uint32_t sf, int lm)
 {
-   int64_t tmp[3];
-   unsigned i;
-
-   for(i = 0; i < 3; i++)
-   {
-      int32_t mulr[3];
-
-      tmp[i] = (int64)crv[i] << 12;
+   int64_t tmp[4];
+   const uint32_t mv_flags = MatrixVector(matrix, v, crv, tmp);
 
-      mulr[0] = matrix->MX[i][0] * v[0];
-      mulr[1] = matrix->MX[i][1] * v[1];
-      mulr[2] = matrix->MX[i][2] * v[2];
+   if(Flags)
+      FLAGS |= mv_flags;
 
-      tmp[i] = A_MV(i, tmp[i] + mulr[0]);
-      tmp[i] = A_MV(i, tmp[i] + mulr[1]);
-      tmp[i] = A_MV(i, tmp[i] + mulr[2]);
+   MAC[1] = tmp[0] >> sf;
+   MAC[2] = tmp[1] >> sf;
+   MAC[3] = tmp[2] >> sf;
 
-      MAC[1 + i] = tmp[i] >> sf;
-   }
-
-   IR1 = Lm_B(0, MAC[1], lm);
-   IR2 = Lm_B(1, MAC[2], lm);
+   IR1 = Lm_B<Flags>(0, MAC[1], lm);
+   IR2 = Lm_B<Flags>(1, MAC[2], lm);
    //printf("FTV: %08x %08x\n", crv[2], (uint32)(tmp[2] >> 12));
-   IR3 = Lm_B_PTZ(2, MAC[3], tmp[2] >> 12, lm);
+   IR3 = Lm_B_PTZ<Flags>(2, MAC[3], tmp[2] >> 12, lm);
 
    Z_FIFO[0] = Z_FIFO[1];
    Z_FIFO[1] = Z_FIFO[2];
    Z_FIFO[2] = Z_FIFO[3];
-   Z_FIFO[3] = Lm_D(tmp[2] >> 12, TRUE);
-}
-
-
-#define DECODE_FIELDS							\
- const uint32_t sf MDFN_NOWARN_UNUSED = (instr & (1 << 19)) ? 12 : 0;		\
- const uint32_t mx MDFN_NOWARN_UNUSED = (instr >> 17) & 0x3;			\
- const uint32_t v_i = (instr >> 15) & 0x3;				\
- const int32* cv MDFN_NOWARN_UNUSED = CRVectors.All[(instr >> 13) & 0x3];	\
- const int lm MDFN_NOWARN_UNUSED = (instr >> 10) & 1;			\
- int16_t v[3] MDFN_NOWARN_UNUSED;					\
- if(v_i == 3)							\
- {								\
-  v[0] = IR1;							\
-  v[1] = IR2;							\
-  v[2] = IR3;							\
- }								\
- else								\
- {								\
-  v[0] = Vectors[v_i][0];					\
-  v[1] = Vectors[v_i][1];					\
-  v[2] = Vectors[v_i][2];					\
- }
+   Z_FIFO[3] = Lm_D<Flags>(tmp[2] >> 12, TRUE);
+}
 
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t SQR(uint32_t instr)
 {
-   DECODE_FIELDS;
 
    MAC[1] = ((IR1 * IR1) >> sf);
    MAC[2] = ((IR2 * IR2) >> sf);
    MAC[3] = ((IR3 * IR3) >> sf);
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
    return(5);
 }
 
 
+template<bool Flags, uint32_t sf, int lm, uint32_t mx, uint32_t v_i, uint32_t cv_i>
 int32_t MVMVA(uint32_t instr)
 {
-   DECODE_FIELDS;
+   int16_t v[3];
+
+   if(v_i == 3)
+   {
+      v[0] = IR1;
+      v[1] = IR2;
+      v[2] = IR3;
+   }
+   else
+   {
+      v[0] = Vectors[v_i][0];
+      v[1] = Vectors[v_i][1];
+      v[2] = Vectors[v_i][2];
+   }
 
-   MultiplyMatrixByVector(&Matrices.All[mx], v, cv, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.All[mx], v, CRVectors.All[cv_i], sf, lm);
 
    return(8);
 }
 
+typedef int32_t (*InstrFunc)(uint32_t instr);
+
+// MVMVA gets its own table, indexed by [Flags][sf][lm][mx:v:cv], so the matrix and vector selection is resolved at compile-time too.
+#define MVMVA_HELPER_CV(F, sf, lm, mx, v_i) MVMVA<F, sf, lm, mx, v_i, 0>, MVMVA<F, sf, lm, mx, v_i, 1>, MVMVA<F, sf, lm, mx, v_i, 2>, MVMVA<F, sf, lm, mx, v_i, 3>
+#define MVMVA_HELPER_V(F, sf, lm, mx) MVMVA_HELPER_CV(F, sf, lm, mx, 0), MVMVA_HELPER_CV(F, sf, lm, mx, 1), MVMVA_HELPER_CV(F, sf, lm, mx, 2), MVMVA_HELPER_CV(F, sf, lm, mx, 3)
+#define MVMVA_HELPER(F, sf, lm) { MVMVA_HELPER_V(F, sf, lm, 0), MVMVA_HELPER_V(F, sf, lm, 1), MVMVA_HELPER_V(F, sf, lm, 2), MVMVA_HELPER_V(F, sf, lm, 3) }
+#define MVMVA_HELPER_SF(F, sf) { MVMVA_HELPER(F, sf, 0), MVMVA_HELPER(F, sf, 1) }
+
+static const InstrFunc MVMVATable[2][2][2][0x40] =
+{
+ { MVMVA_HELPER_SF(false, 0), MVMVA_HELPER_SF(false, 12) },
+ { MVMVA_HELPER_SF(true, 0), MVMVA_HELPER_SF(true, 12) },
+};
+
+#undef MVMVA_HELPER_SF
+#undef MVMVA_HELPER
+#undef MVMVA_HELPER_V
+#undef MVMVA_HELPER_CV
+
+template<bool Flags, uint32_t sf, int lm>
+static int32_t MVMVA_Indirect(uint32_t instr)
+{
+   return MVMVATable[Flags][sf != 0][lm][(instr >> 13) & 0x3F](instr);
+}
+
+template<bool Flags, uint32_t sf, int lm>
+static int32_t Unknown(uint32_t instr)
+{
+#ifndef PSXDEV_GTE_TESTING
+   PSX_WARNING("[GTE] Unknown instruction code: 0x%02x", instr & 0x3F);
+#endif
+   return(1);
+}
+
 static INLINE unsigned CountLeadingZeroU16(uint16_t val)
 {
    unsigned ret = 0;
@@ -1051,6 +1368,7 @@ static INLINE unsigned CountLeadingZeroU16(uint16_t val)
    return ret;
 }
 
+template<bool Flags>
 static INLINE uint32_t Divide(uint32_t dividend, uint32_t divisor)
 {
    //if((Z_FIFO[3] * 2) > H)
@@ -1065,135 +1383,140 @@ static INLINE uint32_t Divide(uint32_t dividend, uint32_t divisor)
    }
    else
    {
-      FLAGS |= 1 << 17;
+      if(Flags) FLAGS |= 1 << 17;
       return 0x1FFFF;
    }
 }
 
+template<bool Flags>
 static INLINE void TransformXY(int64_t h_div_sz)
 {
    MAC[0] = F((int64)OFX + IR1 * h_div_sz) >> 16;
-   XY_FIFO[3].X = Lm_G(0, MAC[0]);
+   XY_FIFO[3].X = Lm_G<Flags>(0, MAC[0]);
 
    MAC[0] = F((int64)OFY + IR2 * h_div_sz) >> 16;
-   XY_FIFO[3].Y = Lm_G(1, MAC[0]);
+   XY_FIFO[3].Y = Lm_G<Flags>(1, MAC[0]);
 
    XY_FIFO[0] = XY_FIFO[1];
    XY_FIFO[1] = XY_FIFO[2];
    XY_FIFO[2] = XY_FIFO[3];
 }
 
+template<bool Flags>
 static INLINE void TransformDQ(int64_t h_div_sz)
 {
    MAC[0] = F((int64)DQB + DQA * h_div_sz);
-   IR0 = Lm_H(((int64)DQB + DQA * h_div_sz) >> 12);
+   IR0 = Lm_H<Flags>(((int64)DQB + DQA * h_div_sz) >> 12);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t RTPS(uint32_t instr)
 {
-   DECODE_FIELDS;
    int64_t h_div_sz;
 
-   MultiplyMatrixByVector_PT(&Matrices.Rot, Vectors[0], CRVectors.T, sf, lm);
-   h_div_sz = Divide(H, Z_FIFO[3]);
+   MultiplyMatrixByVector_PT<Flags>(&Matrices.Rot, Vectors[0], CRVectors.T, sf, lm);
+   h_div_sz = Divide<Flags>(H, Z_FIFO[3]);
 
-   TransformXY(h_div_sz);
-   TransformDQ(h_div_sz);
+   TransformXY<Flags>(h_div_sz);
+   TransformDQ<Flags>(h_div_sz);
 
    return(15);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t RTPT(uint32_t instr)
 {
-   DECODE_FIELDS;
    int i;
 
    for(i = 0; i < 3; i++)
    {
       int64_t h_div_sz;
 
-      MultiplyMatrixByVector_PT(&Matrices.Rot, Vectors[i], CRVectors.T, sf, lm);
-      h_div_sz = Divide(H, Z_FIFO[3]);
+      MultiplyMatrixByVector_PT<Flags>(&Matrices.Rot, Vectors[i], CRVectors.T, sf, lm);
+      h_div_sz = Divide<Flags>(H, Z_FIFO[3]);
 
-      TransformXY(h_div_sz);
+      TransformXY<Flags>(h_div_sz);
 
       if(i == 2)
-         TransformDQ(h_div_sz);
+         TransformDQ<Flags>(h_div_sz);
    }
 
    return(23);
 }
 
+template<bool Flags>
 INLINE void NormColor(uint32_t sf, int lm, uint32_t v)
 {
    int16_t tmp_vector[3];
 
-   MultiplyMatrixByVector(&Matrices.Light, Vectors[v], CRVectors.Null, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Light, Vectors[v], CRVectors.Null, sf, lm);
 
    tmp_vector[0] = IR1; tmp_vector[1] = IR2; tmp_vector[2] = IR3;
-   MultiplyMatrixByVector(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCS(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   NormColor(sf, lm, 0);
+   NormColor<Flags>(sf, lm, 0);
 
    return(14);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCT(uint32_t instr)
 {
-   DECODE_FIELDS;
    int i;
 
    for(i = 0; i < 3; i++)
-      NormColor(sf, lm, i);
+      NormColor<Flags>(sf, lm, i);
 
    return(30);
 }
 
+template<bool Flags>
 INLINE void NormColorColor(uint32_t v, uint32_t sf, int lm)
 {
    int16_t tmp_vector[3];
 
-   MultiplyMatrixByVector(&Matrices.Light, Vectors[v], CRVectors.Null, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Light, Vectors[v], CRVectors.Null, sf, lm);
 
    tmp_vector[0] = IR1; tmp_vector[1] = IR2; tmp_vector[2] = IR3;
-   MultiplyMatrixByVector(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
 
    MAC[1] = ((RGB.R << 4) * IR1) >> sf;
    MAC[2] = ((RGB.G << 4) * IR2) >> sf;
    MAC[3] = ((RGB.B << 4) * IR3) >> sf;
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCCS(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   NormColorColor(0, sf, lm);
+   NormColorColor<Flags>(0, sf, lm);
    return(17);
 }
 
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCCT(uint32_t instr)
 {
    int i;
-   DECODE_FIELDS;
 
    for(i = 0; i < 3; i++)
-      NormColorColor(i, sf, lm);
+      NormColorColor<Flags>(i, sf, lm);
 
    return(39);
 }
 
+template<bool Flags>
 INLINE void DepthCue(int mult_IR123, int RGB_from_FIFO, uint32_t sf, int lm)
 {
    int32_t RGB_temp[3];
@@ -1219,144 +1542,145 @@ INLINE void DepthCue(int mult_IR123, int RGB_from_FIFO, uint32_t sf, int lm)
    {
       for(i = 0; i < 3; i++)
       {
-         MAC[1 + i] = A_MV(i, (((int64)CRVectors.FC[i] << 12) - RGB_temp[i] * IR_temp[i])) >> sf;
-         MAC[1 + i] = A_MV(i, (RGB_temp[i] * IR_temp[i] + IR0 * Lm_B(i, MAC[1 + i], FALSE))) >> sf;
+         MAC[1 + i] = A_MV<Flags>(i, (((int64)CRVectors.FC[i] << 12) - RGB_temp[i] * IR_temp[i])) >> sf;
+         MAC[1 + i] = A_MV<Flags>(i, (RGB_temp[i] * IR_temp[i] + IR0 * Lm_B<Flags>(i, MAC[1 + i], FALSE))) >> sf;
       }
    }
    else
    {
       for(i = 0; i < 3; i++)
       {
-         MAC[1 + i] = A_MV(i, (((int64)CRVectors.FC[i] << 12) - (RGB_temp[i] << 12))) >> sf;
-         MAC[1 + i] = A_MV(i, (((int64)RGB_temp[i] << 12) + IR0 * Lm_B(i, MAC[1 + i], FALSE))) >> sf;
+         MAC[1 + i] = A_MV<Flags>(i, (((int64)CRVectors.FC[i] << 12) - (RGB_temp[i] << 12))) >> sf;
+         MAC[1 + i] = A_MV<Flags>(i, (((int64)RGB_temp[i] << 12) + IR0 * Lm_B<Flags>(i, MAC[1 + i], FALSE))) >> sf;
       }
    }
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 }
 
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t DCPL(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   DepthCue(TRUE, FALSE, sf, lm);
+   DepthCue<Flags>(TRUE, FALSE, sf, lm);
 
    return(8);
 }
 
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t DPCS(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   DepthCue(FALSE, FALSE, sf, lm);
+   DepthCue<Flags>(FALSE, FALSE, sf, lm);
 
    return(8);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t DPCT(uint32_t instr)
 {
    int i;
-   DECODE_FIELDS;
 
    for(i = 0; i < 3; i++)
-      DepthCue(FALSE, TRUE, sf, lm);
+      DepthCue<Flags>(FALSE, TRUE, sf, lm);
 
    return(17);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t INTPL(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   MAC[1] = A_MV(0, (((int64)CRVectors.FC[0] << 12) - (IR1 << 12))) >> sf;
-   MAC[2] = A_MV(1, (((int64)CRVectors.FC[1] << 12) - (IR2 << 12))) >> sf;
-   MAC[3] = A_MV(2, (((int64)CRVectors.FC[2] << 12) - (IR3 << 12))) >> sf;
+   MAC[1] = A_MV<Flags>(0, (((int64)CRVectors.FC[0] << 12) - (IR1 << 12))) >> sf;
+   MAC[2] = A_MV<Flags>(1, (((int64)CRVectors.FC[1] << 12) - (IR2 << 12))) >> sf;
+   MAC[3] = A_MV<Flags>(2, (((int64)CRVectors.FC[2] << 12) - (IR3 << 12))) >> sf;
 
-   MAC[1] = A_MV(0, (((int64)IR1 << 12) + IR0 * Lm_B(0, MAC[1], FALSE)) >> sf);
-   MAC[2] = A_MV(1, (((int64)IR2 << 12) + IR0 * Lm_B(1, MAC[2], FALSE)) >> sf);
-   MAC[3] = A_MV(2, (((int64)IR3 << 12) + IR0 * Lm_B(2, MAC[3], FALSE)) >> sf);
+   MAC[1] = A_MV<Flags>(0, (((int64)IR1 << 12) + IR0 * Lm_B<Flags>(0, MAC[1], FALSE)) >> sf);
+   MAC[2] = A_MV<Flags>(1, (((int64)IR2 << 12) + IR0 * Lm_B<Flags>(1, MAC[2], FALSE)) >> sf);
+   MAC[3] = A_MV<Flags>(2, (((int64)IR3 << 12) + IR0 * Lm_B<Flags>(2, MAC[3], FALSE)) >> sf);
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 
    return(8);
 }
 
 
+template<bool Flags>
 INLINE void NormColorDepthCue(uint32_t v, uint32_t sf, int lm)
 {
    int16_t tmp_vector[3];
 
-   MultiplyMatrixByVector(&Matrices.Light, Vectors[v], CRVectors.Null, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Light, Vectors[v], CRVectors.Null, sf, lm);
 
    tmp_vector[0] = IR1;
    tmp_vector[1] = IR2;
    tmp_vector[2] = IR3;
-   MultiplyMatrixByVector(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
 
-   DepthCue(TRUE, FALSE, sf, lm);
+   DepthCue<Flags>(TRUE, FALSE, sf, lm);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCDS(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   NormColorDepthCue(0, sf, lm);
+   NormColorDepthCue<Flags>(0, sf, lm);
 
    return(19);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCDT(uint32_t instr)
 {
    int i;
-   DECODE_FIELDS;
 
    for(i = 0; i < 3; i++)
-      NormColorDepthCue(i, sf, lm);
+      NormColorDepthCue<Flags>(i, sf, lm);
 
    return(44);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t CC(uint32_t instr)
 {
-   DECODE_FIELDS;
    int16_t tmp_vector[3];
 
    tmp_vector[0] = IR1; tmp_vector[1] = IR2; tmp_vector[2] = IR3;
-   MultiplyMatrixByVector(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
 
    MAC[1] = ((RGB.R << 4) * IR1) >> sf;
    MAC[2] = ((RGB.G << 4) * IR2) >> sf;
    MAC[3] = ((RGB.B << 4) * IR3) >> sf;
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 
    return(11);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t CDP(uint32_t instr)
 {
-   DECODE_FIELDS;
    int16_t tmp_vector[3];
 
    tmp_vector[0] = IR1; tmp_vector[1] = IR2; tmp_vector[2] = IR3;
-   MultiplyMatrixByVector(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
+   MultiplyMatrixByVector<Flags>(&Matrices.Color, tmp_vector, CRVectors.B, sf, lm);
 
-   DepthCue(TRUE, FALSE, sf, lm);
+   DepthCue<Flags>(TRUE, FALSE, sf, lm);
 
    return(13);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t NCLIP(uint32_t instr)
 {
-   DECODE_FIELDS;
 
    MAC[0] = F( (int64)(XY_FIFO[0].X * (XY_FIFO[1].Y - XY_FIFO[2].Y)) + (XY_FIFO[1].X * (XY_FIFO[2].Y - XY_FIFO[0].Y)) + (XY_FIFO[2].X * (XY_FIFO[0].Y - XY_FIFO[1].Y))
          );
@@ -1364,24 +1688,24 @@ int32_t NCLIP(uint32_t instr)
    return(8);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t AVSZ3(uint32_t instr)
 {
-   DECODE_FIELDS;
 
    MAC[0] = F(((int64)ZSF3 * (Z_FIFO[1] + Z_FIFO[2] + Z_FIFO[3])));
 
-   OTZ = Lm_D(MAC[0] >> 12, FALSE);
+   OTZ = Lm_D<Flags>(MAC[0] >> 12, FALSE);
 
    return(5);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t AVSZ4(uint32_t instr)
 {
-   DECODE_FIELDS;
 
    MAC[0] = F(((int64)ZSF4 * (Z_FIFO[0] + Z_FIFO[1] + Z_FIFO[2] + Z_FIFO[3])));
 
-   OTZ = Lm_D(MAC[0] >> 12, FALSE);
+   OTZ = Lm_D<Flags>(MAC[0] >> 12, FALSE);
 
    return(5);
 }
@@ -1389,45 +1713,45 @@ int32_t AVSZ4(uint32_t instr)
 
 // -32768 * -32768 - 32767 * -32768 = 2147450880
 // (2 ^ 31) - 1 =		      2147483647
+template<bool Flags, uint32_t sf, int lm>
 int32_t OP(uint32_t instr)
 {
-   DECODE_FIELDS;
 
    MAC[1] = ((Matrices.Rot.MX[1][1] * IR3) - (Matrices.Rot.MX[2][2] * IR2)) >> sf;
    MAC[2] = ((Matrices.Rot.MX[2][2] * IR1) - (Matrices.Rot.MX[0][0] * IR3)) >> sf;
    MAC[3] = ((Matrices.Rot.MX[0][0] * IR2) - (Matrices.Rot.MX[1][1] * IR1)) >> sf;
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
    return(6);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t GPF(uint32_t instr)
 {
-   DECODE_FIELDS;
 
    MAC[1] = (IR0 * IR1) >> sf;
    MAC[2] = (IR0 * IR2) >> sf;
    MAC[3] = (IR0 * IR3) >> sf;
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 
    return(5);
 }
 
+template<bool Flags, uint32_t sf, int lm>
 int32_t GPL(uint32_t instr)
 {
-   DECODE_FIELDS;
 
-   MAC[1] = A_MV(0, ((int64)MAC[1] << sf) + (IR0 * IR1)) >> sf;
-   MAC[2] = A_MV(1, ((int64)MAC[2] << sf) + (IR0 * IR2)) >> sf;
-   MAC[3] = A_MV(2, ((int64)MAC[3] << sf) + (IR0 * IR3)) >> sf;
+   MAC[1] = A_MV<Flags>(0, ((int64)MAC[1] << sf) + (IR0 * IR1)) >> sf;
+   MAC[2] = A_MV<Flags>(1, ((int64)MAC[2] << sf) + (IR0 * IR2)) >> sf;
+   MAC[3] = A_MV<Flags>(2, ((int64)MAC[3] << sf) + (IR0 * IR3)) >> sf;
 
-   MAC_to_IR(lm);
+   MAC_to_IR<Flags>(lm);
 
-   MAC_to_RGB_FIFO();
+   MAC_to_RGB_FIFO<Flags>();
 
    return(5);
 }
@@ -1458,264 +1782,81 @@ int32_t GPL(uint32_t instr)
  opcode = operation code 
 */
 
-int32_t GTE_Instruction(uint32_t instr)
+static const InstrFunc InstrTable[2][2][2][0x40] =
 {
-   const unsigned code = instr & 0x3F;
-   int32_t ret = 1;
-
-   FLAGS = 0;
-
-   switch(code)
-   {
-      default: 
-#ifndef PSXDEV_GTE_TESTING
-         PSX_WARNING("[GTE] Unknown instruction code: 0x%02x", code);
-#endif
-         break;
-
-      case 0x00:	// alternate?
-      case 0x01:
-         ret = RTPS(instr);
-         break;
-
-         /*
-            case 0x02:	// UNSTABLE?
-            break;
-
-            case 0x03:	// UNSTABLE?
-            break;
-
-            case 0x04:	// Probably simple with v,cv,sf,mx,lm ignored.  Same calculation as 0x3B?
-            break;
-
-            case 0x05:	// UNSTABLE?
-            break;
-            */
-
-      case 0x06:
-         ret = NCLIP(instr);
-         break;
-
-         /*
-            case 0x07:	// UNSTABLE?
-            break;
-
-            case 0x08:	// UNSTABLE?
-            break;
-
-            case 0x09:	// UNSTABLE?
-            break;
-
-            case 0x0A:	// UNSTABLE?
-            break;
-
-            case 0x0B:	// UNSTABLE?
-            break;
-
-*/
-
-      case 0x0C:
-         ret = OP(instr);
-         break;
-
-         /*
-            case 0x0D:	// UNSTABLE?
-            break;
-
-            case 0x0E:	// UNSTABLE?
-            break;
-
-            case 0x0F:	// UNSTABLE?
-            break;
-            */
-
-      case 0x10:
-         ret = DPCS(instr);
-         break;
-
-      case 0x11:
-         ret = INTPL(instr);
-         break;
-
-      case 0x12:
-         ret = MVMVA(instr);
-         break;
-
-      case 0x13:
-         ret = NCDS(instr);
-         break;
-
-      case 0x14:
-         ret = CDP(instr);
-         break;
-
-
-         /*
-            case 0x15:	// does one push on RGB FIFO, what else...
-            break;
-            */
-
-      case 0x16:
-         ret = NCDT(instr);
-         break;
-
-         /*
-            case 0x17:	// PARTIALLY UNSTABLE(depending on sf or v or cv or mx or lm???), similar behavior under some conditions to 0x16?
-            break;
-
-            case 0x18:
-            break;
-
-            case 0x19:
-            break;
-            */
-
-      case 0x1A:	// Alternate for 0x29?
-         ret = DCPL(instr);
-         break;
-
-      case 0x1B:
-         ret = NCCS(instr);
-         break;
-
-      case 0x1C:
-         ret = CC(instr);
-         break;
-
-         /*
-            case 0x1D:
-            break;
-            */
-
-      case 0x1E:
-         ret = NCS(instr);
-         break;
-
-         /*
-            case 0x1F:
-            break;
-            */
-
-      case 0x20:
-         ret = NCT(instr);
-         break;
-         /*
-            case 0x21:
-            break;
-
-            case 0x22:	// UNSTABLE?
-            break;
-
-            case 0x23:
-            break;
-
-            case 0x24:
-            break;
-
-            case 0x25:
-            break;
-
-            case 0x26:
-            break;
-
-            case 0x27:
-            break;
-            */
-
-      case 0x28:
-         ret = SQR(instr);
-         break;
-
-      case 0x29:
-         ret = DCPL(instr);
-         break;
-
-      case 0x2A:
-         ret = DPCT(instr);
-         break;
-
-         /*
-            case 0x2B:
-            break;
-
-            case 0x2C:
-            break;
-            */
-
-      case 0x2D:
-         ret = AVSZ3(instr);
-         break;
-
-      case 0x2E:
-         ret = AVSZ4(instr);
-         break;
+#include "gte_instr_table.inc"
+};
 
-         /*
-            case 0x2F:	// UNSTABLE?
-            break;
-            */
+template<bool Flags>
+static INLINE int32_t GTE_Execute(uint32_t instr)
+{
+   int32_t ret;
 
-      case 0x30:
-         ret = RTPT(instr);
-         break;
+   FLAGS = 0;
 
-         /*
-            case 0x31:	// UNSTABLE?
-            break;
+   ret = InstrTable[Flags][(instr >> 19) & 1][(instr >> 10) & 1][instr & 0x3F](instr);
 
-            case 0x32:	// UNSTABLE?
-            break;
+   if(Flags)
+   {
+      if(FLAGS & 0x7f87e000)
+         FLAGS |= 1 << 31;
 
-            case 0x33:	// UNSTABLE?
-            break;
+      CR[31] = FLAGS;
+   }
 
-            case 0x34:	// UNSTABLE?
-            break;
+   return(ret - 1);
+}
 
-            case 0x35:	// UNSTABLE?
-            break;
+static void LazyFlags_Resolve(void)
+{
+   LazyDR cur_dr;
+   LazyCR cur_cr;
+   uint32_t flags_cr;
 
-            case 0x36:	// UNSTABLE?
-            break;
+   if(!Lazy.Pending)
+      return;
 
-            case 0x37:	// UNSTABLE?
-            break;
+   Lazy.Pending = false;
 
-            case 0x38:
-            break;
+   LazyDR_Copy(&cur_dr, true, LAZY_ALL);
+   LazyDR_Copy(&Lazy.DR, false, Lazy.inputs);
 
-            case 0x39:	// Probably simple with v,cv,sf,mx,lm ignored.
-            break;
+   if(Lazy.HaveCR)
+   {
+      LazyCR_Copy(&cur_cr, true);
+      LazyCR_Copy(&Lazy.CR, false);
+   }
 
-            case 0x3A:	// Probably simple with v,cv,sf,mx,lm ignored.
-            break;
+   GTE_Execute<true>(Lazy.instr);
+   flags_cr = CR[31];
 
-            case 0x3B:	// Probably simple with v,cv,sf,mx,lm ignored.  Same calculation as 0x04?
-            break;
+   if(Lazy.HaveCR)
+      LazyCR_Copy(&cur_cr, false);
 
-            case 0x3C:	// UNSTABLE?
-            break;
-            */
+   LazyDR_Copy(&cur_dr, false, LAZY_ALL);
+   CR[31] = flags_cr;
+}
 
-      case 0x3D:
-         ret = GPF(instr);
-         break;
+void GTE_SetLazyFlags(bool enabled)
+{
+   LazyFlags_Resolve();
+   LazyFlags = enabled;
+}
 
-      case 0x3E:
-         ret = GPL(instr);
-         break;
+int32_t GTE_Instruction(uint32_t instr)
+{
+   if(LazyFlags)
+   {
+      Lazy.instr = instr;
+      Lazy.inputs = LazyInputs[instr & 0x3F];
+      LazyDR_Copy(&Lazy.DR, true, Lazy.inputs);
+      Lazy.HaveCR = false;
+      Lazy.Pending = true;
 
-      case 0x3F:
-         ret = NCCT(instr);
-         break;
+      return(GTE_Execute<false>(instr));
    }
 
-   if(FLAGS & 0x7f87e000)
-      FLAGS |= 1 << 31;
-
-   CR[31] = FLAGS;
-
-   return(ret - 1);
+   return(GTE_Execute<true>(instr));
 }
 
 #ifndef PSXDEV_GTE_TESTING
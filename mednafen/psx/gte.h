@@ -4,11 +4,15 @@
 namespace MDFN_IEN_PSX
 {
 
+void GTE_Init(void) MDFN_COLD;
 void GTE_Power(void);
 int GTE_StateAction(StateMem *sm, int load, int data_only);
 
 int32 GTE_Instruction(uint32_t instr);
 
+// Defers computing FLAGS until CR 31 is actually read; see gte.cpp
+void GTE_SetLazyFlags(bool enabled) MDFN_COLD;
+
 void GTE_WriteCR(unsigned int which, uint32_t value);
 void GTE_WriteDR(unsigned int which, uint32_t value);
 
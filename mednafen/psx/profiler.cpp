@@ -0,0 +1,230 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "psx.h"
+#include "profiler.h"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+/*
+ Samples are taken where the CPU stops for events(timers, GPU lines, CDC, DMA...), which happens several thousand times
+ per emulated second at fairly even intervals, and each one is weighted by the cycles run since the previous one.  That's
+ cheap enough to leave on for a whole session, at the cost of some aliasing with code that waits for those same events.
+
+ The "caller" is whatever $ra holds, which is exact for leaf functions and the call site of the current function for most
+ others(compilers for the R3000A only save $ra when they have to).
+*/
+
+namespace MDFN_IEN_PSX
+{
+
+enum
+{
+   PROF_REGION_RAM = 0,
+   PROF_REGION_SCRATCHPAD,
+   PROF_REGION_BIOS,
+   PROF_REGION_EXPANSION,
+   PROF_REGION_OTHER,
+   PROF_REGION__COUNT
+};
+
+static const char *const RegionNames[PROF_REGION__COUNT] = { "ram", "scratchpad", "bios", "expansion", "other" };
+
+static std::map<uint64_t, uint64_t> CallCycles;	// (ra << 32) | pc
+static uint64_t RegionCycles[PROF_REGION__COUNT];
+static uint64_t TotalCycles;
+static uint64_t TotalSamples;
+
+static std::map<uint32_t, std::string> Symbols;
+
+static unsigned GetRegion(uint32_t A)
+{
+   A &= 0x1FFFFFFF;
+
+   if(A < 0x00800000)
+      return(PROF_REGION_RAM);
+
+   if(A >= 0x1F800000 && A <= 0x1F8003FF)
+      return(PROF_REGION_SCRATCHPAD);
+
+   if(A >= 0x1FC00000 && A <= 0x1FC7FFFF)
+      return(PROF_REGION_BIOS);
+
+   if(A >= 0x1F000000 && A <= 0x1F7FFFFF)
+      return(PROF_REGION_EXPANSION);
+
+   return(PROF_REGION_OTHER);
+}
+
+void PROF_Reset(void)
+{
+   CallCycles.clear();
+   memset(RegionCycles, 0, sizeof(RegionCycles));
+   TotalCycles = 0;
+   TotalSamples = 0;
+}
+
+void PROF_Sample(uint32_t pc, uint32_t ra, pscpu_timestamp_t cycles)
+{
+   if(cycles <= 0)
+      return;
+
+   CallCycles[((uint64_t)ra << 32) | pc] += cycles;
+   RegionCycles[GetRegion(pc)] += cycles;
+   TotalCycles += cycles;
+   TotalSamples++;
+}
+
+bool PROF_HaveSamples(void)
+{
+   return(TotalSamples != 0);
+}
+
+static void LoadSymbols(const char *path)
+{
+   FILE *fp;
+   char linebuf[512];
+
+   Symbols.clear();
+
+   if(!path || !(fp = fopen(path, "rb")))
+      return;
+
+   while(fgets(linebuf, sizeof(linebuf), fp))
+   {
+      char *endp;
+      char *name;
+      unsigned long A = strtoul(linebuf, &endp, 16);
+
+      if(endp == linebuf)
+         continue;
+
+      // Name is the last field, so "80010000 T main" works as well as "80010000 main".
+      name = NULL;
+      for(char *tok = strtok(endp, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n"))
+         name = tok;
+
+      if(name)
+         Symbols[A] = name;
+   }
+
+   fclose(fp);
+}
+
+// Symbol name of the function containing A, or its address if we don't know.
+static std::string Symbolize(uint32_t A, bool with_offset)
+{
+   std::map<uint32_t, std::string>::iterator it = Symbols.upper_bound(A);
+   char buf[64];
+
+   // BIOS function table dispatchers; the function number is in $t1.
+   switch(A & 0x1FFFFFFF)
+   {
+      case 0xA0: return("bios_A0h");
+      case 0xB0: return("bios_B0h");
+      case 0xC0: return("bios_C0h");
+   }
+
+   if(it != Symbols.begin() && GetRegion((--it)->first) == GetRegion(A))
+   {
+      if(!with_offset || it->first == A)
+         return(it->second);
+
+      trio_snprintf(buf, sizeof(buf), "+0x%x", A - it->first);
+      return(it->second + buf);
+   }
+
+   trio_snprintf(buf, sizeof(buf), "%08x", A);
+   return(buf);
+}
+
+static bool CompareCycles(const std::pair<uint32_t, uint64_t> &a, const std::pair<uint32_t, uint64_t> &b)
+{
+   return(a.second > b.second);
+}
+
+static void WriteTop(FILE *fp, const char *title, std::map<uint32_t, uint64_t> &m, unsigned max)
+{
+   std::vector< std::pair<uint32_t, uint64_t> > v(m.begin(), m.end());
+
+   std::sort(v.begin(), v.end(), CompareCycles);
+
+   fprintf(fp, "\n%s:\n", title);
+
+   for(unsigned i = 0; i < v.size() && i < max; i++)
+   {
+      fprintf(fp, "  %6.2f%%  %12llu  %08x  %-10s  %s\n", 100.0 * v[i].second / TotalCycles, (unsigned long long)v[i].second, v[i].first,
+	RegionNames[GetRegion(v[i].first)], Symbolize(v[i].first, true).c_str());
+   }
+}
+
+void PROF_Dump(const char *txt_path, const char *folded_path, const char *sym_path)
+{
+   std::map<uint32_t, uint64_t> PCCycles;
+   std::map<uint32_t, uint64_t> CallerCycles;
+   std::map<std::string, uint64_t> Stacks;
+   FILE *fp;
+
+   if(!TotalSamples)
+      return;
+
+   LoadSymbols(sym_path);
+
+   for(std::map<uint64_t, uint64_t>::iterator it = CallCycles.begin(); it != CallCycles.end(); ++it)
+   {
+      const uint32_t pc = (uint32_t)it->first;
+      const uint32_t ra = it->first >> 32;
+      std::string stack;
+
+      PCCycles[pc] += it->second;
+
+      // $ra points past the delay slot of the call.
+      CallerCycles[ra - 8] += it->second;
+
+      stack = std::string(RegionNames[GetRegion(pc)]) + ";" + Symbolize(ra - 8, false) + ";" + Symbolize(pc, false);
+      Stacks[stack] += it->second;
+   }
+
+   if((fp = fopen(txt_path, "wb")))
+   {
+      fprintf(fp, "Guest CPU profile: %llu samples, %llu cycles\n", (unsigned long long)TotalSamples, (unsigned long long)TotalCycles);
+
+      fprintf(fp, "\nRegions:\n");
+      for(unsigned r = 0; r < PROF_REGION__COUNT; r++)
+      {
+         if(RegionCycles[r])
+            fprintf(fp, "  %6.2f%%  %12llu  %s\n", 100.0 * RegionCycles[r] / TotalCycles, (unsigned long long)RegionCycles[r], RegionNames[r]);
+      }
+
+      WriteTop(fp, "Top PCs", PCCycles, 100);
+      WriteTop(fp, "Top callers($ra - 8)", CallerCycles, 50);
+      fclose(fp);
+   }
+
+   if((fp = fopen(folded_path, "wb")))
+   {
+      for(std::map<std::string, uint64_t>::iterator it = Stacks.begin(); it != Stacks.end(); ++it)
+         fprintf(fp, "%s %llu\n", it->first.c_str(), (unsigned long long)it->second);
+      fclose(fp);
+   }
+
+   Symbols.clear();
+}
+
+}
@@ -0,0 +1,19 @@
+#ifndef __MDFN_PSX_PROFILER_H
+#define __MDFN_PSX_PROFILER_H
+
+namespace MDFN_IEN_PSX
+{
+
+// Sampling profiler for guest code.  When enabled with PS_CPU::SetProfiling(), PS_CPU::RunReal() calls PROF_Sample() each
+// time it stops to run events, with the cycles run since the previous sample.
+void PROF_Reset(void);
+void PROF_Sample(uint32_t pc, uint32_t ra, pscpu_timestamp_t cycles);
+bool PROF_HaveSamples(void);
+
+// Writes a text report to txt_path, and the samples in the collapsed stack format of flamegraph.pl to folded_path.  Addresses
+// are symbolized from sym_path("address name" lines, as from nm) if that can be opened.
+void PROF_Dump(const char *txt_path, const char *folded_path, const char *sym_path);
+
+}
+
+#endif
@@ -90,6 +90,9 @@ namespace MDFN_IEN_PSX
 
  void PSX_GPULineHook(const pscpu_timestamp_t timestamp, const pscpu_timestamp_t line_timestamp, bool vsync, uint32_t *pixels, const MDFN_PixelFormat* const format, const unsigned width, const unsigned pix_clock_offset, const unsigned pix_clock, const unsigned pix_clock_divide);
 
+ // Returns true if PSX_GPULineHook() looks at the pixels passed to it(lightguns).
+ bool PSX_GPULineHookReadsPixels(void);
+
  uint32_t PSX_GetRandU32(uint32_t mina, uint32_t maxa);
 };
 
@@ -101,6 +104,7 @@ namespace MDFN_IEN_PSX
 #include "dma.h"
 //#include "sio.h"
 #include "debug.h"
+#include "profiler.h"
 
 namespace MDFN_IEN_PSX
 {
@@ -76,6 +76,13 @@
 
 #include "../clamp.h"
 
+#include <math.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+ #define SPU_HAVE_X86_SIMD 1
+ #include <immintrin.h>
+#endif
+
 uint32_t IntermediateBufferPos;
 int16_t IntermediateBuffer[4096][2];
 
@@ -92,10 +99,42 @@ static const uint32_t NoiseFreqTable[64] =
  #include "spu_nft.inc"
 };
 
+// Vector code used by the voice mix and reverb, picked once at startup.
+enum
+{
+   SPU_SIMD_NONE = 0,
+   SPU_SIMD_SSE41,
+   SPU_SIMD_AVX2
+};
+
+static unsigned SelectSIMD(void)
+{
+#ifdef SPU_HAVE_X86_SIMD
+   __builtin_cpu_init();
+
+   if(__builtin_cpu_supports("avx2"))
+      return(SPU_SIMD_AVX2);
+
+   if(__builtin_cpu_supports("sse4.1"))
+      return(SPU_SIMD_SSE41);
+#endif
+
+   return(SPU_SIMD_NONE);
+}
+
+static const unsigned SIMDLevel = SelectSIMD();
+
 PS_SPU::PS_SPU()
 {
    IntermediateBufferPos = 0;
    memset(IntermediateBuffer, 0, sizeof(IntermediateBuffer));
+   memset(&MixLanes, 0, sizeof(MixLanes));
+
+   last_rate = -1;
+   last_quality = 0;
+   ResampL = ResampM = 0;
+
+   ClearDecodeCache();
 }
 
 PS_SPU::~PS_SPU()
@@ -109,6 +148,7 @@ void PS_SPU::Power(void)
    clock_divider = 768;
 
    memset(SPURAM, 0, sizeof(SPURAM));
+   ClearDecodeCache();
 
    for(i = 0; i < 24; i++)
    {
@@ -281,11 +321,51 @@ INLINE void SPU_Sweep::WriteVolume(int16_t value)
    Current = value;
 }
 
+void PS_SPU::DecodeBlock(uint32_t addr, int32_t hist1, int32_t hist2, int16 *out)
+{
+   // 5 through 0xF appear to be 0 on the real thing.
+   static const int32_t Weights[16][2] =
+   {
+      // s-1    s-2
+      {   0,    0 },
+      {  60,    0 },
+      { 115,  -52 },
+      {  98,  -55 },
+      { 122,  -60 },
+   };
+   uint16_t settings, coded;
+   uint32_t shift, weight;
+
+   coded = 0;
+   settings = SPURAM[(addr++) & 0x3FFFF];
+   shift = settings & 0xF;
+   weight = (settings >> 4) & 0xF;
+
+   for(int i = 0; i < 28; i++)
+   {
+      int32_t sample;
+
+      if(!(i & 3))
+         coded = SPURAM[(addr++) & 0x3FFFF];
+
+      sample = (int16)((coded & 0xF) << 12);
+      sample >>= shift;
+
+      sample += ((hist1 * Weights[weight][0]) >> 6) + ((hist2 * Weights[weight][1]) >> 6);
+      clamp(&sample, -32768, 32767);
+
+      out[i] = sample;
+      hist2 = hist1;
+      hist1 = sample;
+
+      coded >>= 4;
+   }
+}
+
 void PS_SPU::DecodeSamples(SPU_Voice *voice)
 {
    int i;
-   uint16_t settings, coded;
-   uint32_t flags, shift, weight;
+   uint32_t flags;
 
    // Handle delayed flags from the previously-decoded block.
    if(voice->DecodeFlags & 0x1)
@@ -298,49 +378,51 @@ void PS_SPU::DecodeSamples(SPU_Voice *voice)
          {
             voice->ADSR.Phase = ADSR_RELEASE;
             voice->ADSR.EnvLevel = 0;
+            voice->ADSR.StepWait = 0;
          }
       }
    }
 
    // Note: Only voice->CurAddr &= 0x3FFFF at the end so IRQ address testing will work.
-   // 5 through 0xF appear to be 0 on the real thing.
-   static const int32_t Weights[16][2] =
-   {
-      // s-1    s-2
-      {   0,    0 },
-      {  60,    0 },
-      { 115,  -52 },
-      {  98,  -55 },
-      { 122,  -60 },
-   };
    const uint32_t PrevCurAddr = voice->CurAddr;
+   const int32_t hist1 = voice->DecodeBuffer[(voice->DecodeWritePos - 1) & 0x1F];
+   const int32_t hist2 = voice->DecodeBuffer[(voice->DecodeWritePos - 2) & 0x1F];
+   const int16 *samples;
+   int16 uncached[28];
 
-   coded = 0;
-   settings = SPURAM[(voice->CurAddr++) & 0x3FFFF];
-   shift = settings & 0xF;
-   weight = (settings >> 4) & 0xF;
-   flags = (settings >> 8) & 0xFF;
+   flags = (SPURAM[PrevCurAddr & 0x3FFFF] >> 8) & 0xFF;
 
-   for(i = 0; i < 28; i++)
+   // Decoding only depends on the block's contents and the last two samples decoded before it, so a block played again(e.g. the loop
+   // of an instrument sample) with the same history comes out the same; see DecodeCache.
+   if(MDFN_LIKELY(!(PrevCurAddr & 0x7)))
    {
-      int32_t sample;
+      SPU_DecodeCacheEntry *dce = &DecodeCache[(PrevCurAddr >> 3) & (DecodeCacheSize - 1)];
 
-      if(!(i & 3))
-         coded = SPURAM[(voice->CurAddr++) & 0x3FFFF];
+      if(dce->Block != (PrevCurAddr >> 3) || dce->Hist[0] != hist1 || dce->Hist[1] != hist2)
+      {
+         DecodeBlock(PrevCurAddr, hist1, hist2, dce->Samples);
 
-      sample = (int16)((coded & 0xF) << 12);
-      sample >>= shift;
+         dce->Block = PrevCurAddr >> 3;
+         dce->Hist[0] = hist1;
+         dce->Hist[1] = hist2;
+      }
 
-      sample += ((voice->DecodeBuffer[(voice->DecodeWritePos - 1) & 0x1F] * Weights[weight][0]) >> 6)
-         + ((voice->DecodeBuffer[(voice->DecodeWritePos - 2) & 0x1F] * Weights[weight][1]) >> 6);
-      clamp(&sample, -32768, 32767);
+      samples = dce->Samples;
+   }
+   else
+   {
+      DecodeBlock(PrevCurAddr, hist1, hist2, uncached);
+      samples = uncached;
+   }
 
-      voice->DecodeBuffer[voice->DecodeWritePos] = sample;
+   for(i = 0; i < 28; i++)
+   {
+      voice->DecodeBuffer[voice->DecodeWritePos] = samples[i];
       voice->DecodeWritePos = (voice->DecodeWritePos + 1) & 0x1F;
-
-      coded >>= 4;
    }
 
+   voice->CurAddr += 8;
+
    // SPU IRQ
    if(SPUControl & 0x40)
    {
@@ -403,6 +485,7 @@ void PS_SPU::CacheEnvelope(SPU_Voice *voice)
    ADSR->ReleaseRate = Rr << 2;
 
    ADSR->SustainLevel = (Sl + 1) << 11;
+   ADSR->StepWait = 0;
 }
 
 void PS_SPU::ResetEnvelope(SPU_Voice *voice)
@@ -412,6 +495,7 @@ void PS_SPU::ResetEnvelope(SPU_Voice *voice)
    ADSR->EnvLevel = 0;
    ADSR->Divider = 0;
    ADSR->Phase = ADSR_ATTACK;
+   ADSR->StepWait = 0;
 }
 
 void PS_SPU::ReleaseEnvelope(SPU_Voice *voice)
@@ -420,6 +504,7 @@ void PS_SPU::ReleaseEnvelope(SPU_Voice *voice)
 
    ADSR->Divider = 0;
    ADSR->Phase = ADSR_RELEASE;
+   ADSR->StepWait = 0;
 }
 
 
@@ -480,7 +565,19 @@ void PS_SPU::RunEnvelope(SPU_Voice *voice)
       }
       if(ADSR->Phase == ADSR_DECAY && (uint16)ADSR->EnvLevel < ADSR->SustainLevel)
          ADSR->Phase++;
+
+      ADSR->StepWait = 0;
+   }
+   else if(ADSR->Divider < 0x8000)
+   {
+      // Nothing changed but the divider, so the next calls compute the same divinco, and do nothing but add it to the divider until
+      // it reaches 0x8000; VoiceMixFinish() does that itself for the StepWait samples before then.  Anything else that changes the
+      // envelope state zeroes StepWait.
+      ADSR->StepWait = divinco ? ((0x7FFF - ADSR->Divider) / divinco) : ~0U;
+      ADSR->StepDivInc = divinco;
    }
+   else
+      ADSR->StepWait = 0;
 }
 
 INLINE void PS_SPU::CheckIRQAddr(uint32_t addr)
@@ -496,11 +593,26 @@ INLINE void PS_SPU::CheckIRQAddr(uint32_t addr)
    }
 }
 
+INLINE void PS_SPU::InvalidateDecodeCache(uint32_t addr)
+{
+   SPU_DecodeCacheEntry *dce = &DecodeCache[(addr >> 3) & (DecodeCacheSize - 1)];
+
+   if(dce->Block == (addr >> 3))
+      dce->Block = 0xFFFF;
+}
+
+void PS_SPU::ClearDecodeCache(void)
+{
+   for(unsigned i = 0; i < DecodeCacheSize; i++)
+      DecodeCache[i].Block = 0xFFFF;
+}
+
 INLINE void PS_SPU::WriteSPURAM(uint32_t addr, uint16_t value)
 {
    CheckIRQAddr(addr);
 
    SPURAM[addr] = value;
+   InvalidateDecodeCache(addr);
 }
 
 INLINE uint16_t PS_SPU::ReadSPURAM(uint32_t addr)
@@ -510,6 +622,7 @@ INLINE uint16_t PS_SPU::ReadSPURAM(uint32_t addr)
 }
 
 #include "spu_reverb.inc"
+#include "spu_mix.inc"
 
 int32_t PS_SPU::UpdateFromCDC(int32_t clocks)
 //pscpu_timestamp_t PS_SPU::Update(const pscpu_timestamp_t timestamp)
@@ -577,134 +690,38 @@ int32_t PS_SPU::UpdateFromCDC(int32_t clocks)
       if(Regs[0xD6] == 0x4)	// TODO: Investigate more(case 0x2C in global regs r/w handler)
          SPUStatus |= (CWA & 0x100) ? 0x800 : 0x000;
 
-      for(int voice_num = 0; voice_num < 24; voice_num++)
       {
-         SPU_Voice *voice = &Voices[voice_num];
-         int32_t voice_pvs;
-
-         voice->PreLRSample = 0;
+         int32_t accum[4] = { 0, 0, 0, 0 };
 
-         //PSX_WARNING("[SPU] Voice %d CurPhase=%08x, pitch=%04x, CurAddr=%08x", voice_num, voice->CurPhase, voice->Pitch, voice->CurAddr);
+         MixActive = 0;
 
-         // Decode new samples if necessary.
-         if(voice->DecodeFlags & 0x1)
-            voice->CurAddr = voice->LoopAddr & ~0x7;
-
-         if(voice->CurPhase_SD >= (24 << 12))
+         if(MDFN_UNLIKELY(MixCaptureConflict()))
          {
-            voice->CurPhase_SD -= 28 << 12;
-            DecodeSamples(voice);
-         }
-         else
-         {
-            CheckIRQAddr(voice->CurAddr);
-         }
-         //
-         //
-         //
-         int l, r;
-
-         if(Noise_Mode & (1 << voice_num))
-            voice_pvs = (int16)LFSR;
-         else
-         {
-            const int si = voice->CurPhase >> 12;
-            const int pi = ((voice->CurPhase & 0xFFF) >> 4);
-
-            voice_pvs = ((voice->DecodeBuffer[si + 0] * FIR_Table[pi][0]) +
-                  (voice->DecodeBuffer[si + 1] * FIR_Table[pi][1]) +
-                  (voice->DecodeBuffer[si + 2] * FIR_Table[pi][2]) +   
-                  (voice->DecodeBuffer[si + 3] * FIR_Table[pi][3])) >> 15;
-         }
-
-         voice_pvs = (voice_pvs * (int16)voice->ADSR.EnvLevel) >> 15;
-         voice->PreLRSample = voice_pvs;
-
-         if(voice_num == 1 || voice_num == 3)
-         {
-            int index = voice_num >> 1;
-
-            WriteSPURAM(0x400 | (index * 0x200) | CWA, voice_pvs);
-         }
-
-
-         l = (voice_pvs * voice->Sweep[0].ReadVolume()) >> 15;
-         r = (voice_pvs * voice->Sweep[1].ReadVolume()) >> 15;
-
-         accum_l += l;
-         accum_r += r;
-
-         if(Reverb_Mode & (1 << voice_num))
-         {
-            accum_fv_l += l;
-            accum_fv_r += r;
-         }
-
-         // Run sweep
-         for(int lr = 0; lr < 2; lr++)
-            voice->Sweep[lr].Clock();
-
-         // Run enveloping
-         RunEnvelope(voice);
-
-         // Increment stuff
-         {
-            int32_t phase_inc;
-
-            if(PhaseModCache & (1 << voice_num))
+            for(int voice_num = 0; voice_num < 24; voice_num++)
             {
-               // This old formula: phase_inc = (voice->Pitch * ((voice - 1)->PreLRSample + 0x8000)) >> 15;
-               // is incorrect, as it does not handle carrier pitches >= 0x8000 properly.
-
-               phase_inc = voice->Pitch + (((int16)voice->Pitch * ((voice - 1)->PreLRSample)) >> 15);
-               if(phase_inc < 0)
-               {
-                  PSX_DBG(PSX_DBG_ERROR, "[SPU] phase_inc < 0 (THIS SHOULD NOT HAPPEN)\n");
-                  phase_inc = 0;
-               }
-            }
-            else
-               phase_inc = voice->Pitch;
-
-            if(phase_inc > 0x3FFF)
-               phase_inc = 0x3FFF;
+               VoiceMixPrep(voice_num);
 
-            voice->CurPhase = (voice->CurPhase + phase_inc) & 0x1FFFF;
-            voice->CurPhase_SD += phase_inc;
-         }
+               if(MixActive & (1 << voice_num))
+                  MixVoices_Scalar(voice_num, 1, accum);
 
-         if(VoiceOff & (1 << voice_num))
-         {
-            if(voice->ADSR.Phase != ADSR_RELEASE)
-            {
-               ReleaseEnvelope(voice);
+               VoiceMixFinish(voice_num, PhaseModCache);
             }
          }
-
-         if(VoiceOn & (1 << voice_num))
+         else
          {
-            ResetEnvelope(voice);
+            for(int voice_num = 0; voice_num < 24; voice_num++)
+               VoiceMixPrep(voice_num);
 
-            voice->DecodeFlags = 0;
-            voice->DecodeWritePos = 0;
+            MixVoices(accum);
 
-            BlockEnd &= ~(1 << voice_num);
-
-            // Weight/filter previous value initialization:
-            voice->DecodeBuffer[0x1E] = 0;
-            voice->DecodeBuffer[0x1F] = 0;
-
-            voice->CurPhase = 0;
-            voice->CurPhase_SD = 28 << 12;	 // Trigger initial sample decode
-
-            voice->CurAddr = voice->StartAddr & ~0x7;
+            for(int voice_num = 0; voice_num < 24; voice_num++)
+               VoiceMixFinish(voice_num, PhaseModCache);
          }
 
-         if(!(SPUControl & 0x8000))
-         {
-            voice->ADSR.Phase = ADSR_RELEASE;
-            voice->ADSR.EnvLevel = 0;
-         }
+         accum_l += accum[0];
+         accum_r += accum[1];
+         accum_fv_l += accum[2];
+         accum_fv_r += accum[3];
       }
 
       VoiceOff = 0;
@@ -880,6 +897,7 @@ void PS_SPU::Write(pscpu_timestamp_t timestamp, uint32_t A, uint16_t V)
             break;
          case 0x0C:
             voice->ADSR.EnvLevel = V;
+            voice->ADSR.StepWait = 0;
             break;
          case 0x0E:
             voice->LoopAddr = (V << 2) & 0x3FFFF;
@@ -1084,14 +1102,7 @@ uint16_t PS_SPU::Read(pscpu_timestamp_t timestamp, uint32_t A)
    return(Regs[(A & 0x1FF) >> 1]);
 }
 
-void PS_SPU::StartFrame(double rate, uint32_t quality)
-{
-}
-
-int32_t PS_SPU::EndFrame(int16_t *SoundBuf)
-{
-   return 0;
-}
+#include "spu_resamp.inc"
 
 #define SFSWEEP(r) SFVAR((r).Control),	\
       SFVAR((r).Current),	\
@@ -1213,7 +1224,10 @@ int PS_SPU::StateAction(StateMem *sm, int load, int data_only)
 
    if(load)
    {
+      for(unsigned i = 0; i < 24; i++)
+         Voices[i].ADSR.StepWait = 0;
 
+      ClearDecodeCache();
    }
 
    return ret;
@@ -1227,6 +1241,7 @@ uint16_t PS_SPU::PeekSPURAM(uint32_t address)
 void PS_SPU::PokeSPURAM(uint32_t address, uint16_t value)
 {
    SPURAM[address & 0x3FFFF] = value;
+   InvalidateDecodeCache(address & 0x3FFFF);
 }
 
 uint32_t PS_SPU::GetRegister(unsigned int which, char *special, const uint32_t special_len)
@@ -36,6 +36,10 @@ struct SPU_ADSR
  int32_t ReleaseRate;	// Rr * 4
 
  int32_t SustainLevel;	// (Sl + 1) << 11
+
+ // Not saved; see RunEnvelope().
+ uint32_t StepWait;	// Number of upcoming samples in which the envelope only adds StepDivInc to Divider.
+ int32_t StepDivInc;
 };
 
 class PS_SPU;
@@ -88,6 +92,14 @@ struct SPU_Voice
  SPU_ADSR ADSR;
 };
 
+// A decoded 28-sample ADPCM block; see PS_SPU::DecodeCache.
+struct SPU_DecodeCacheEntry
+{
+ int16 Samples[28];
+ int16 Hist[2];		// The two samples decoded before the block, that it was decoded with.
+ uint16 Block;		// SPU RAM address >> 3, or 0xFFFF if unused.
+};
+
 class PS_SPU
 {
  public:
@@ -104,6 +116,10 @@ class PS_SPU
  void WriteDMA(uint32_t V);
  uint32_t ReadDMA(void);
 
+ // EndFrame() converts the frame's IntermediateBuffer[] to the rate set with StartFrame(), and returns how many sample frames it wrote
+ // to SoundBuf, which needs room for EndFrameMaxFrames.
+ enum { ResampMaxRate = 96000, EndFrameMaxFrames = (4096 * ResampMaxRate) / 44100 + 2 };
+
  void StartFrame(double rate, uint32_t quality);
  int32_t EndFrame(int16 *SoundBuf);
 
@@ -116,19 +132,41 @@ class PS_SPU
  void WriteSPURAM(uint32_t addr, uint16_t value);
  uint16_t ReadSPURAM(uint32_t addr);
 
+ void DecodeBlock(uint32_t addr, int32_t hist1, int32_t hist2, int16 *out);
  void DecodeSamples(SPU_Voice *voice);
 
+ void InvalidateDecodeCache(uint32_t addr);
+ void ClearDecodeCache(void);
+
  void CacheEnvelope(SPU_Voice *voice);
  void ResetEnvelope(SPU_Voice *voice);
  void ReleaseEnvelope(SPU_Voice *voice);
  void RunEnvelope(SPU_Voice *voice);
 
+ bool MixCaptureConflict(void);
+ void VoiceMixPrep(int voice_num);
+ void MixVoices(int32_t *accum);
+ void MixVoices_Scalar(int first, int count, int32_t *accum);
+ void VoiceMixFinish(int voice_num, const uint32_t PhaseModCache);
+
 
  void RunReverb(int32_t in_l, int32_t in_r, int32_t &out_l, int32_t &out_r);
  bool GetCDAudio(int32_t &l, int32_t &r);
 
  SPU_Voice Voices[24];
 
+ // Per-sample staging for the voice mix, one lane per voice; see spu_mix.inc.
+ struct
+ {
+  int32_t s[4][24];	// Decoded samples to interpolate between.
+  int32_t c[4][24];	// FIR_Table[] coefficients.
+  int32_t env[24];
+  int32_t vol[2][24];
+  int32_t reverb[24];	// ~0 if the voice goes to reverb.
+  int32_t pvs[24];	// Output, pre-L/R volume.
+ } MixLanes;
+ uint32_t MixActive;	// Voices with a non-zero envelope level this sample; the rest output 0.
+
  uint32_t NoiseCounter;
  uint16_t LFSR;
 
@@ -228,8 +266,10 @@ class PS_SPU
  int32_t ReverbCur;
 
  int32_t Get_Reverb_Offset(int32_t offset);
- int32_t RD_RVB(int16 raw_offs);
- void WR_RVB(int16 raw_offs, int32_t sample, int32_t extra_offs = 0);
+ void ReverbOffsets(int32_t *offs);
+ void WR_RVB(int32_t offs, int32_t sample);
+ void ReverbIIR(const int32_t *in, const int32_t *downsampled, int32_t *out);
+ void ReverbMix(const int32_t *in, int32_t *out);
 
  bool IRQAsserted;
 
@@ -238,9 +278,24 @@ class PS_SPU
 
  uint16_t SPURAM[524288 / sizeof(uint16)];
 
+ // Blocks decoded by DecodeSamples(), direct-mapped by SPU RAM address; an entry is dropped when its block is written to.
+ enum { DecodeCacheSize = 8192 };
+ SPU_DecodeCacheEntry DecodeCache[DecodeCacheSize];
+
+ // Output resampling; see spu_resamp.inc.
+ enum { ResampMaxTaps = 48, ResampMaxPhases = 1024 };
+
  int last_rate;
  uint32_t last_quality;
 
+ uint32_t ResampL, ResampM;	// Output rate / input rate, in lowest terms; 0 when not resampling.
+ uint32_t ResampTaps;
+ uint32_t ResampPhase;
+ uint32_t ResampBufPos;		// Where in ResampBuf the next output's dot product starts.
+ uint32_t ResampBufCount;
+ std::vector<int16> ResampCoeffs;	// [ResampL][ResampTaps]
+ int16 ResampBuf[2][ResampMaxTaps + 4096];
+
  public:
  enum
  {
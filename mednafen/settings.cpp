@@ -25,6 +25,19 @@ uint32_t setting_psx_multitap_port_1 = 0;
 uint32_t setting_psx_multitap_port_2 = 0;
 uint32_t setting_psx_analog_toggle = 0;
 uint32_t setting_psx_fastboot = 1;
+uint32_t setting_psx_cpu_core = 0;
+uint32_t setting_psx_bios_hle = 0;
+uint32_t setting_psx_profiler = 0;
+uint32_t setting_psx_gte_lazy_flags = 0;
+uint32_t setting_psx_gpu_thread = 0;
+uint32_t setting_psx_gpu_band_threads = 1;
+uint32_t setting_psx_gpu_simd = 1;
+uint32_t setting_psx_gpu_texcache = 16;
+uint32_t setting_psx_gpu_dup_frames = 1;
+uint32_t setting_psx_frameskip = 0;
+uint32_t setting_psx_gpu_record = 0;
+uint32_t setting_psx_audio_rate = 44100;
+uint32_t setting_psx_spu_resamp_quality = 4;
 
 bool MDFN_SaveSettings(const char *path)
 {
@@ -33,8 +46,14 @@ bool MDFN_SaveSettings(const char *path)
 
 uint64 MDFN_GetSettingUI(const char *name)
 {
-   if (!strcmp("psx.spu.resamp_quality", name)) /* make configurable */
-      return 4;
+   if (!strcmp("psx.spu.resamp_quality", name))
+      return setting_psx_spu_resamp_quality;
+   if (!strcmp("psx.cpu_core", name))
+      return setting_psx_cpu_core; /* 0 = interpreter, 1 = cached interpreter, 2 = dynarec */
+   if (!strcmp("psx.gpu_band_threads", name))
+      return setting_psx_gpu_band_threads;
+   if (!strcmp("psx.gpu_texcache", name))
+      return setting_psx_gpu_texcache;
 
    fprintf(stderr, "unhandled setting UI: %s\n", name);
    return 0;
@@ -72,6 +91,18 @@ bool MDFN_GetSettingB(const char *name)
    /* LIBRETRO */
    if (!strcmp("libretro.cd_load_into_ram", name))
       return 0;
+   if (!strcmp("psx.bios_hle", name))
+      return setting_psx_bios_hle;
+   if (!strcmp("psx.profiler", name))
+      return setting_psx_profiler;
+   if (!strcmp("psx.gte_lazy_flags", name))
+      return setting_psx_gte_lazy_flags;
+   if (!strcmp("psx.gpu_thread", name))
+      return setting_psx_gpu_thread;
+   if (!strcmp("psx.gpu_simd", name))
+      return setting_psx_gpu_simd;
+   if (!strcmp("psx.gpu_dup_frames", name))
+      return setting_psx_gpu_dup_frames;
    if (!strcmp("psx.input.port1.memcard", name))
       return 1;
    if (!strcmp("psx.input.port2.memcard", name))
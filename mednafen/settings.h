@@ -7,6 +7,19 @@ extern uint32_t setting_psx_multitap_port_1;
 extern uint32_t setting_psx_multitap_port_2;
 extern uint32_t setting_psx_analog_toggle;
 extern uint32_t setting_psx_fastboot;
+extern uint32_t setting_psx_cpu_core;
+extern uint32_t setting_psx_bios_hle;
+extern uint32_t setting_psx_profiler;
+extern uint32_t setting_psx_gte_lazy_flags;
+extern uint32_t setting_psx_gpu_thread;
+extern uint32_t setting_psx_gpu_band_threads;
+extern uint32_t setting_psx_gpu_simd;
+extern uint32_t setting_psx_gpu_texcache;
+extern uint32_t setting_psx_gpu_dup_frames;
+extern uint32_t setting_psx_frameskip;
+extern uint32_t setting_psx_gpu_record;
+extern uint32_t setting_psx_audio_rate;
+extern uint32_t setting_psx_spu_resamp_quality;
 
 bool MDFN_LoadSettings(const char *path, const char *section = NULL, bool override = false);
 bool MDFN_MergeSettings(const void*);
@@ -39,6 +39,13 @@ void Deinterlacer::SetType(unsigned dt)
  }
 }
 
+// Start of line y; 16bpp builds pack two pixels to each 32-bit one of a line(see MDFN_Surface::Init()).
+template<typename T>
+static INLINE T *LinePtr(MDFN_Surface *surface, int32 y)
+{
+ return((T *)(surface->pixels + y * surface->pitchinpix));
+}
+
 template<typename T>
 void Deinterlacer::InternalProcess(MDFN_Surface *surface, MDFN_Rect &DisplayRect, int32 *LineWidths, const bool field)
 {
@@ -75,15 +82,15 @@ void Deinterlacer::InternalProcess(MDFN_Surface *surface, MDFN_Rect &DisplayRect
 
   if(XReposition)
   {
-    memmove(surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitchinpix,
-	    surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitchinpix + XReposition,
+    memmove(LinePtr<T>(surface, (y * 2) + field + DisplayRect.y),
+	    LinePtr<T>(surface, (y * 2) + field + DisplayRect.y) + XReposition,
 	    LineWidths[(y * 2) + field + DisplayRect.y] * sizeof(T));
   }
 
   if(WeaveGood)
   {
-   const T* src = FieldBuffer->pixels + y * FieldBuffer->pitchinpix;
-   T* dest = surface->pixels + ((y * 2) + (field ^ 1) + DisplayRect.y) * surface->pitchinpix + DisplayRect.x;
+   const T* src = LinePtr<T>(FieldBuffer, y);
+   T* dest = LinePtr<T>(surface, (y * 2) + (field ^ 1) + DisplayRect.y) + DisplayRect.x;
    int32 *dest_lw = &LineWidths[(y * 2) + (field ^ 1) + DisplayRect.y];
 
    *dest_lw = LWBuffer[y];
@@ -92,8 +99,8 @@ void Deinterlacer::InternalProcess(MDFN_Surface *surface, MDFN_Rect &DisplayRect
   }
   else if(DeintType == DEINT_BOB)
   {
-   const T* src = surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitchinpix + DisplayRect.x;
-   T* dest = surface->pixels + ((y * 2) + (field ^ 1) + DisplayRect.y) * surface->pitchinpix + DisplayRect.x;
+   const T* src = LinePtr<T>(surface, (y * 2) + field + DisplayRect.y) + DisplayRect.x;
+   T* dest = LinePtr<T>(surface, (y * 2) + (field ^ 1) + DisplayRect.y) + DisplayRect.x;
    const int32 *src_lw = &LineWidths[(y * 2) + field + DisplayRect.y];
    int32 *dest_lw = &LineWidths[(y * 2) + (field ^ 1) + DisplayRect.y];
 
@@ -104,14 +111,14 @@ void Deinterlacer::InternalProcess(MDFN_Surface *surface, MDFN_Rect &DisplayRect
   else
   {
    const int32 *src_lw = &LineWidths[(y * 2) + field + DisplayRect.y];
-   const T* src = surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitchinpix + DisplayRect.x;
+   const T* src = LinePtr<T>(surface, (y * 2) + field + DisplayRect.y) + DisplayRect.x;
    const int32 dly = ((y * 2) + (field + 1) + DisplayRect.y);
-   T* dest = surface->pixels + dly * surface->pitchinpix + DisplayRect.x;
+   T* dest = LinePtr<T>(surface, dly) + DisplayRect.x;
 
    if(y == 0 && field)
    {
     T black = surface->MakeColor(0, 0, 0);
-    T* dm2 = surface->pixels + (dly - 2) * surface->pitchinpix;
+    T* dm2 = LinePtr<T>(surface, dly - 2);
 
     LineWidths[dly - 2] = *src_lw;
 
@@ -135,10 +142,10 @@ void Deinterlacer::InternalProcess(MDFN_Surface *surface, MDFN_Rect &DisplayRect
   if(DeintType == DEINT_WEAVE)
   {
    const int32 *src_lw = &LineWidths[(y * 2) + field + DisplayRect.y];
-   const T* src = surface->pixels + ((y * 2) + field + DisplayRect.y) * surface->pitchinpix + DisplayRect.x;
-   T* dest = FieldBuffer->pixels + y * FieldBuffer->pitchinpix;
+   const T* src = LinePtr<T>(surface, (y * 2) + field + DisplayRect.y) + DisplayRect.x;
+   T* dest = LinePtr<T>(FieldBuffer, y);
 
-   memcpy(dest, src, *src_lw * sizeof(uint32));
+   memcpy(dest, src, *src_lw * sizeof(T));
    LWBuffer[y] = *src_lw;
 
    StateValid = true;
@@ -73,8 +73,14 @@ void MDFN_Surface::Init(void *const p_pixels, const uint32 p_width, const uint32
    palette = NULL;
 #endif
 
+#if defined(WANT_16BPP)
+   // 16bpp pixels are packed two to each 32-bit one of a line, with the pitch still in 32-bit pixels(see ScanoutPixel in psx/gpu.h).
+   if(!(rpix = calloc(1, p_pitchinpix * p_height * sizeof(uint32))))
+      throw(1);
+#else
    if(!(rpix = calloc(1, p_pitchinpix * p_height * (nf.bpp / 8))))
       throw(1);
+#endif
 
 #if defined(WANT_8BPP)
    //if(nf.bpp == 8)
@@ -84,7 +90,10 @@ void MDFN_Surface::Init(void *const p_pixels, const uint32 p_width, const uint32
    }
 #elif defined(WANT_16BPP)
    //if(nf.bpp == 16)
+   {
       pixels16 = (uint16 *)rpix;
+      pixels = (uint32 *)rpix;
+   }
 #elif defined(WANT_32BPP)
    //else
       pixels = (uint32 *)rpix;
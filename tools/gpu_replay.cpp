@@ -0,0 +1,526 @@
+/*
+ gpu_replay - benchmarks PS_GPU on a recording of its command stream(see mednafen/psx/gpu_record.inc; set the "psx_gpu_record" core
+ option to make one, which goes to the save directory as "<content>.<md5>.gpurec").
+
+ The recording is read into memory first, then fed into a PS_GPU of our own with nothing else running; the rest of the emulator is
+ stubbed out below.  Reports frames per second, and per GP0 command byte, how many commands were run, at what rate, and how many pixels
+ they covered per second while running.  GPURAM hashes recorded at the end of each frame and values the CPU read from the GPU are checked
+ along the way; the exit status is 1 if any differ.
+
+ Usage: gpu_replay [options] <recording>
+   -threads <n>    Band threads, as the "psx_gpu_band_threads" core option(default 1).
+   -async          Render on a separate thread, as "psx_gpu_thread".
+   -nosimd         Don't use the SIMD span rasterizer.
+   -texcache <n>   Texture page cache entries(default 16; 0 to disable).
+   -nodup          Convert every display line, rather than skipping unchanged ones.
+   -repeat <n>     Replay the recording n times(default 1), from the start each time.
+   -notime         Don't time each command, for fps figures without the clock reads.
+*/
+
+#include "mednafen/psx/psx.h"
+#include "mednafen/psx/timer.h"
+#include "thread.h"
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace MDFN_IEN_PSX;
+
+extern void PSXDitherApply(bool);
+
+MDFNGI *MDFNGameInfo = NULL;
+
+//
+// What PS_GPU needs from the rest of the emulator.
+//
+namespace MDFN_IEN_PSX
+{
+void IRQ_Assert(int which, bool asserted) { }
+
+void TIMER_AddDotClocks(uint32 count) { }
+void TIMER_ClockHRetrace(void) { }
+void TIMER_SetHRetrace(bool status) { }
+void TIMER_SetVBlank(bool status) { }
+pscpu_timestamp_t TIMER_Update(const pscpu_timestamp_t timestamp) { return PSX_EVENT_MAXTS; }
+
+void PSX_SetEventNT(const int type, const pscpu_timestamp_t next_timestamp) { }
+void PSX_RequestMLExit(void) { }
+
+void PSX_GPULineHook(const pscpu_timestamp_t timestamp, const pscpu_timestamp_t line_timestamp, bool vsync, uint32_t *pixels, const MDFN_PixelFormat* const format, const unsigned width, const unsigned pix_clock_offset, const unsigned pix_clock, const unsigned pix_clock_divide) { }
+bool PSX_GPULineHookReadsPixels(void) { return false; }
+}
+
+void MDFND_Sleep(unsigned int time)
+{
+   usleep(time * 1000);
+}
+
+MDFN_Thread *MDFND_CreateThread(int (*fn)(void *), void *data)
+{
+   return (MDFN_Thread*)sthread_create((void (*)(void*))fn, data);
+}
+
+void MDFND_WaitThread(MDFN_Thread *thr, int *val)
+{
+   sthread_join((sthread_t*)thr);
+
+   if (val)
+      *val = 0;
+}
+
+MDFN_Mutex *MDFND_CreateMutex()
+{
+   return (MDFN_Mutex*)slock_new();
+}
+
+void MDFND_DestroyMutex(MDFN_Mutex *lock)
+{
+   slock_free((slock_t*)lock);
+}
+
+int MDFND_LockMutex(MDFN_Mutex *lock)
+{
+   slock_lock((slock_t*)lock);
+   return 0;
+}
+
+int MDFND_UnlockMutex(MDFN_Mutex *lock)
+{
+   slock_unlock((slock_t*)lock);
+   return 0;
+}
+
+MDFN_Cond *MDFND_CreateCond()
+{
+   return (MDFN_Cond*)scond_new();
+}
+
+void MDFND_DestroyCond(MDFN_Cond *cond)
+{
+   scond_free((scond_t*)cond);
+}
+
+int MDFND_WaitCond(MDFN_Cond *cond, MDFN_Mutex *lock)
+{
+   scond_wait((scond_t*)cond, (slock_t*)lock);
+   return 0;
+}
+
+int MDFND_SignalCond(MDFN_Cond *cond)
+{
+   scond_signal((scond_t*)cond);
+   return 0;
+}
+
+//
+//
+//
+static uint64 GetTimeNS(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return (uint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static const char *CommandKind(unsigned cc)
+{
+   if (cc == 0x02)
+      return "fill";
+   if (cc >= 0x20 && cc < 0x40)
+      return "polygon";
+   if (cc >= 0x40 && cc < 0x60)
+      return "line";
+   if (cc >= 0x60 && cc < 0x80)
+      return "sprite";
+   if (cc >= 0x80 && cc < 0xA0)
+      return "vram->vram";
+   if (cc >= 0xA0 && cc < 0xC0)
+      return "cpu->vram";
+   if (cc >= 0xC0 && cc < 0xE0)
+      return "vram->cpu";
+   if (cc >= 0xE1 && cc <= 0xE6)
+      return "environment";
+
+   return "";
+}
+
+struct Recording
+{
+   std::vector<uint8> data;
+   bool pal;
+   bool dither;
+   int sls, sle;
+   uint32 state_pos, state_len;
+   uint32 events_pos;
+};
+
+static bool LoadRecording(const char *path, Recording *rec)
+{
+   FILE *fp = fopen(path, "rb");
+   uint8 buf[65536];
+   size_t len;
+
+   if (!fp)
+   {
+      fprintf(stderr, "Couldn't open %s\n", path);
+      return false;
+   }
+
+   while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+      rec->data.insert(rec->data.end(), buf, buf + len);
+
+   fclose(fp);
+
+   if (rec->data.size() < 22 || memcmp(&rec->data[0], "PSXGPURC", 8))
+   {
+      fprintf(stderr, "%s isn't a GPU recording\n", path);
+      return false;
+   }
+
+   if (MDFN_de32lsb(&rec->data[8]) != PS_GPU::REC_VERSION)
+   {
+      fprintf(stderr, "%s is a version %u recording; this reads version %u\n", path, MDFN_de32lsb(&rec->data[8]), (unsigned)PS_GPU::REC_VERSION);
+      return false;
+   }
+
+   rec->pal = rec->data[12];
+   rec->dither = rec->data[13];
+   rec->sls = (int16)MDFN_de16lsb(&rec->data[14]);
+   rec->sle = (int16)MDFN_de16lsb(&rec->data[16]);
+   rec->state_pos = 22;
+   rec->state_len = MDFN_de32lsb(&rec->data[18]);
+   rec->events_pos = rec->state_pos + rec->state_len;
+
+   if (rec->events_pos > rec->data.size())
+   {
+      fprintf(stderr, "%s is truncated\n", path);
+      return false;
+   }
+
+   return true;
+}
+
+struct ReplayResults
+{
+   uint32 frames;
+   uint32 hash_mismatches;
+   uint32 read_mismatches;
+   int32 first_mismatch;	// Frame, or -1.
+   uint64 time;		// Not counting hashing.
+};
+
+class EventReader
+{
+   public:
+
+   EventReader(const Recording *rec) : p(&rec->data[rec->events_pos]), end(&rec->data[0] + rec->data.size()), last_ts(0) { }
+
+   INLINE bool AtEnd(void)
+   {
+      return p == end;
+   }
+
+   INLINE uint8 Byte(void)
+   {
+      return (p < end) ? *p++ : 0;
+   }
+
+   INLINE uint32 Var(void)
+   {
+      uint32 ret = 0;
+
+      for (unsigned shift = 0; p < end && shift < 35; shift += 7)
+      {
+         const uint8 b = *p++;
+
+         ret |= (uint32)(b & 0x7F) << shift;
+
+         if (!(b & 0x80))
+            break;
+      }
+
+      return ret;
+   }
+
+   INLINE pscpu_timestamp_t TS(void)
+   {
+      const uint32 zz = Var();
+
+      last_ts += (int32)((zz >> 1) ^ (0 - (zz & 1)));
+
+      return last_ts;
+   }
+
+   INLINE uint64 Hash(void)
+   {
+      uint64 ret = 0;
+
+      if (end - p >= 8)
+         ret = MDFN_de64lsb(p);
+      p = std::min(p + 8, end);
+
+      return ret;
+   }
+
+   const uint8 *p;
+   const uint8 *end;
+   pscpu_timestamp_t last_ts;
+};
+
+static bool Replay(const Recording *rec, PS_GPU *gpu, ReplayResults *res)
+{
+   static int32 line_widths[576];
+   static MDFN_Surface *surface = NULL;
+   EmulateSpecStruct espec;
+   EventReader ev(rec);
+   uint64 start_time;
+
+   if (!surface)
+   {
+      MDFN_PixelFormat pix_fmt(MDFN_COLORSPACE_RGB, 16, 8, 0, 24);
+
+      surface = new MDFN_Surface(NULL, 700, 576, 700, pix_fmt);
+   }
+
+   {
+      StateMem sm;
+
+      memset(&sm, 0, sizeof(sm));
+      sm.data = (uint8 *)&rec->data[rec->state_pos];
+      sm.len = rec->state_len;
+
+      if (!gpu->StateAction(&sm, 1, 0))
+      {
+         fprintf(stderr, "Couldn't load the recording's GPU state\n");
+         return false;
+      }
+   }
+
+   memset(&espec, 0, sizeof(espec));
+   espec.surface = surface;
+   espec.LineWidths = line_widths;
+
+   start_time = GetTimeNS();
+
+   while (!ev.AtEnd())
+   {
+      const uint8 type = ev.Byte();
+
+      switch (type)
+      {
+         default:
+            fprintf(stderr, "Unknown event type %u at offset %u\n", type, (unsigned)(ev.p - 1 - &rec->data[0]));
+            return false;
+
+         case PS_GPU::REC_WRITE:
+            {
+               const pscpu_timestamp_t ts = ev.TS();
+               const uint32 A = ev.Var();
+               const uint32 V = ev.Var();
+
+               gpu->Write(ts, A, V);
+            }
+            break;
+
+         case PS_GPU::REC_READ:
+            {
+               const pscpu_timestamp_t ts = ev.TS();
+               const uint32 A = ev.Var();
+               const uint32 V = ev.Var();
+
+               if (gpu->Read(ts, A) != V)
+                  res->read_mismatches++;
+            }
+            break;
+
+         case PS_GPU::REC_WRITE_DMA:
+            gpu->WriteDMA(ev.Var());
+            break;
+
+         case PS_GPU::REC_READ_DMA:
+            if (gpu->ReadDMA() != ev.Var())
+               res->read_mismatches++;
+            break;
+
+         case PS_GPU::REC_UPDATE:
+            gpu->Update(ev.TS());
+            break;
+
+         case PS_GPU::REC_RESET_TS:
+            gpu->ResetTS();
+            ev.last_ts = 0;
+            break;
+
+         case PS_GPU::REC_POWER:
+            gpu->Power();
+            break;
+
+         case PS_GPU::REC_START_FRAME:
+            espec.skip = ev.Var();
+            gpu->StartFrame(&espec);
+            break;
+
+         case PS_GPU::REC_SKIP_DRAW:
+            gpu->SetSkipDraw(ev.Var());
+            break;
+
+         case PS_GPU::REC_POKE:
+            {
+               const uint32 A = ev.Var();
+               const uint32 V = ev.Var();
+
+               gpu->PokeRAM(A, V);
+            }
+            break;
+
+         case PS_GPU::REC_FRAME_END:
+            {
+               const uint64 expected = ev.Hash();
+               uint64 hash_start;
+
+               gpu->SyncRender();
+               hash_start = GetTimeNS();
+
+               if (gpu->HashVRAM() != expected)
+               {
+                  if (!res->hash_mismatches)
+                     res->first_mismatch = res->frames;
+                  res->hash_mismatches++;
+               }
+
+               res->frames++;
+               start_time += GetTimeNS() - hash_start;
+            }
+            break;
+      }
+   }
+
+   gpu->SyncRender();
+   res->time += GetTimeNS() - start_time;
+
+   return true;
+}
+
+static void Usage(void)
+{
+   fprintf(stderr, "Usage: gpu_replay [-threads n] [-async] [-nosimd] [-texcache n] [-nodup] [-repeat n] [-notime] <recording>\n");
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned threads = 1;
+   bool async = false;
+   bool simd = true;
+   unsigned texcache = 16;
+   bool dup = true;
+   unsigned repeat = 1;
+   bool cmd_time = true;
+   const char *path = NULL;
+   Recording rec;
+   ReplayResults res;
+   PS_GPU::CommandStats stats[256];
+   PS_GPU::CommandStats total;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-threads") && (i + 1) < argc)
+         threads = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-async"))
+         async = true;
+      else if (!strcmp(argv[i], "-nosimd"))
+         simd = false;
+      else if (!strcmp(argv[i], "-texcache") && (i + 1) < argc)
+         texcache = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-nodup"))
+         dup = false;
+      else if (!strcmp(argv[i], "-repeat") && (i + 1) < argc)
+         repeat = std::max(1, atoi(argv[++i]));
+      else if (!strcmp(argv[i], "-notime"))
+         cmd_time = false;
+      else if (argv[i][0] != '-' && !path)
+         path = argv[i];
+      else
+      {
+         Usage();
+         return 2;
+      }
+   }
+
+   if (!path)
+   {
+      Usage();
+      return 2;
+   }
+
+   if (!LoadRecording(path, &rec))
+      return 2;
+
+   PSXDitherApply(rec.dither);
+
+   memset(&res, 0, sizeof(res));
+   res.first_mismatch = -1;
+   memset(stats, 0, sizeof(stats));
+
+   for (unsigned pass = 0; pass < repeat; pass++)
+   {
+      PS_GPU *gpu = new PS_GPU(rec.pal, rec.sls, rec.sle);
+      bool ok;
+
+      gpu->Power();
+      gpu->SetBandThreads(threads);
+      gpu->SetSpanSIMD(simd);
+      gpu->SetTexCacheSize(texcache);
+      gpu->SetDupFrames(dup);
+      gpu->SetAsyncRender(async);
+      gpu->SetCommandStats(stats, cmd_time ? GetTimeNS : NULL);
+
+      ok = Replay(&rec, gpu, &res);
+
+      gpu->SetCommandStats(NULL, NULL);
+      delete gpu;
+
+      if (!ok)
+         return 2;
+   }
+
+   printf("%u frames in %.3f s: %.1f fps\n", res.frames, res.time / 1e9, res.time ? res.frames * 1e9 / res.time : 0.0);
+
+   memset(&total, 0, sizeof(total));
+   printf("\n cmd  kind           count      time%%   cmds/s(running)   Mpix/s(running)\n");
+
+   for (unsigned cc = 0; cc < 256; cc++)
+   {
+      const PS_GPU::CommandStats *s = &stats[cc];
+
+      if (!s->count && !s->pixels)
+         continue;
+
+      total.count += s->count;
+      total.pixels += s->pixels;
+      total.time += s->time;
+
+      if (cmd_time)
+         printf(" %02x   %-12s %10llu   %6.2f   %15.0f   %15.2f\n", cc, CommandKind(cc), (unsigned long long)s->count, res.time ? s->time * 100.0 / res.time : 0.0,
+               s->time ? s->count * 1e9 / s->time : 0.0, s->time ? s->pixels * 1e3 / s->time : 0.0);
+      else
+         printf(" %02x   %-12s %10llu   %llu pixels\n", cc, CommandKind(cc), (unsigned long long)s->count, (unsigned long long)s->pixels);
+   }
+
+   if (cmd_time)
+      printf(" all                %10llu   %6.2f   %15.0f   %15.2f\n", (unsigned long long)total.count, res.time ? total.time * 100.0 / res.time : 0.0,
+            total.time ? total.count * 1e9 / total.time : 0.0, total.time ? total.pixels * 1e3 / total.time : 0.0);
+
+   printf("\n");
+
+   if (res.hash_mismatches)
+      printf("GPURAM hash mismatches: %u of %u frames(first at frame %d)\n", res.hash_mismatches, res.frames, res.first_mismatch);
+   else
+      printf("GPURAM hashes match for all %u frames\n", res.frames);
+
+   if (res.read_mismatches)
+      printf("GPU reads that differ from the recording: %u\n", res.read_mismatches);
+
+   return (res.hash_mismatches || res.read_mismatches) ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+/*
+ gte_bench - benchmarks the GTE with and without lazy FLAGS(see GTE_SetLazyFlags() and the comment above LazyDR in
+ mednafen/psx/gte.cpp), and checks that both give the same results.
+
+ A seeded random stream of GTE register writes and instructions is generated into memory first, then run once with FLAGS computed
+ by every instruction, and once with them deferred until CR 31 is read; the rest of the emulator isn't involved.  Every CR 31 read,
+ and all of the GTE registers at the end, must be identical between the two; the exit status is 1 if any differ.  Random register
+ values hit the overflow and saturation flags far more often than games do, which is what the check wants.
+
+ Usage: gte_bench [options]
+   -count <n>      Instructions in the stream(default 1000000).
+   -read <n>       Read CR 31 after 1 in n instructions(default 16; 1 for after every one).
+   -seed <n>       Random seed(default 1).
+   -repeat <n>     Run the stream n times in each mode(default 4), keeping the fastest time.
+*/
+
+#include "mednafen/psx/psx.h"
+#include "mednafen/psx/gte.h"
+
+#include <time.h>
+
+#include <vector>
+
+using namespace MDFN_IEN_PSX;
+
+//
+// What the GTE needs from the rest of the emulator.
+//
+int MDFNSS_StateAction(void *st, int load, int data_only, SFORMAT *sf, const char *name, bool optional)
+{
+   return 1;
+}
+
+//
+//
+//
+static uint64 GetTimeNS(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return (uint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+enum
+{
+   EV_WRITE_DR = 0,
+   EV_WRITE_CR,
+   EV_INSTR,
+   EV_READ_FLAGS
+};
+
+struct Event
+{
+   uint8 type;
+   uint8 reg;
+   uint32 value;
+};
+
+static uint64 rng_state;
+
+static uint32 Rand(void)
+{
+   // xorshift64*
+   rng_state ^= rng_state >> 12;
+   rng_state ^= rng_state << 25;
+   rng_state ^= rng_state >> 27;
+
+   return (uint32)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+// Opcodes with an implementation; the rest just warn.
+static const uint8 Opcodes[] =
+{
+   0x01, 0x06, 0x0C, 0x10, 0x11, 0x12, 0x13, 0x14, 0x16, 0x1A, 0x1B, 0x1C, 0x1E,
+   0x20, 0x28, 0x29, 0x2A, 0x2D, 0x2E, 0x30, 0x3D, 0x3E, 0x3F
+};
+
+static void Generate(std::vector<Event> *events, unsigned count, unsigned read)
+{
+   Event ev;
+
+   for (unsigned i = 0; i < count; i++)
+   {
+      const unsigned dr_writes = Rand() % 6;
+
+      for (unsigned j = 0; j < dr_writes; j++)
+      {
+         ev.type = EV_WRITE_DR;
+         ev.reg = Rand() & 0x1F;
+         ev.value = Rand();
+         events->push_back(ev);
+      }
+
+      // Games set up the matrices and such far less often than they write vertices.
+      if (!(Rand() & 0x1F))
+      {
+         ev.type = EV_WRITE_CR;
+         ev.reg = Rand() % 31;
+         ev.value = Rand();
+         events->push_back(ev);
+      }
+
+      // sf, mx, v, cv and lm at random.
+      ev.type = EV_INSTR;
+      ev.reg = 0;
+      ev.value = 0x4A000000 | (Rand() & 0x000FE400) | Opcodes[Rand() % (sizeof(Opcodes) / sizeof(Opcodes[0]))];
+      events->push_back(ev);
+
+      // A write after the instruction, which a deferred FLAGS mustn't see.
+      if (!(Rand() & 0x7))
+      {
+         ev.type = (Rand() & 1) ? EV_WRITE_CR : EV_WRITE_DR;
+         ev.reg = Rand() % 31;
+         ev.value = Rand();
+         events->push_back(ev);
+      }
+
+      if (!(Rand() % read))
+      {
+         ev.type = EV_READ_FLAGS;
+         ev.reg = 31;
+         ev.value = 0;
+         events->push_back(ev);
+      }
+   }
+}
+
+// Returns the time taken, in ns; CR 31 reads go to reads, and the final registers to regs(DR 0-31, then CR 0-31).
+static uint64 Run(const std::vector<Event> &events, bool lazy, std::vector<uint32> *reads, uint32 *regs)
+{
+   uint64 start_time;
+   uint64 time;
+
+   GTE_Power();
+   GTE_SetLazyFlags(lazy);
+   reads->clear();
+
+   start_time = GetTimeNS();
+
+   for (size_t i = 0; i < events.size(); i++)
+   {
+      const Event *ev = &events[i];
+
+      switch (ev->type)
+      {
+         case EV_WRITE_DR:
+            GTE_WriteDR(ev->reg, ev->value);
+            break;
+
+         case EV_WRITE_CR:
+            GTE_WriteCR(ev->reg, ev->value);
+            break;
+
+         case EV_INSTR:
+            GTE_Instruction(ev->value);
+            break;
+
+         case EV_READ_FLAGS:
+            reads->push_back(GTE_ReadCR(31));
+            break;
+      }
+   }
+
+   time = GetTimeNS() - start_time;
+
+   for (unsigned i = 0; i < 32; i++)
+   {
+      regs[i] = GTE_ReadDR(i);
+      regs[32 + i] = GTE_ReadCR(i);
+   }
+
+   GTE_SetLazyFlags(false);
+
+   return time;
+}
+
+static void Usage(void)
+{
+   fprintf(stderr, "Usage: gte_bench [-count n] [-read n] [-seed n] [-repeat n]\n");
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned count = 1000000;
+   unsigned read = 16;
+   unsigned seed = 1;
+   unsigned repeat = 4;
+   std::vector<Event> events;
+   std::vector<uint32> eager_reads, lazy_reads;
+   uint32 eager_regs[64], lazy_regs[64];
+   uint64 eager_time = ~(uint64)0;
+   uint64 lazy_time = ~(uint64)0;
+   unsigned read_mismatches = 0;
+   int first_mismatch = -1;
+   unsigned reg_mismatches = 0;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-count") && (i + 1) < argc)
+         count = std::max(1, atoi(argv[++i]));
+      else if (!strcmp(argv[i], "-read") && (i + 1) < argc)
+         read = std::max(1, atoi(argv[++i]));
+      else if (!strcmp(argv[i], "-seed") && (i + 1) < argc)
+         seed = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-repeat") && (i + 1) < argc)
+         repeat = std::max(1, atoi(argv[++i]));
+      else
+      {
+         Usage();
+         return 2;
+      }
+   }
+
+   GTE_Init();
+
+   rng_state = 0x9E3779B97F4A7C15ULL ^ seed;
+   Generate(&events, count, read);
+
+   for (unsigned pass = 0; pass < repeat; pass++)
+   {
+      eager_time = std::min(eager_time, Run(events, false, &eager_reads, eager_regs));
+      lazy_time = std::min(lazy_time, Run(events, true, &lazy_reads, lazy_regs));
+   }
+
+   for (size_t i = 0; i < eager_reads.size(); i++)
+   {
+      if (eager_reads[i] != lazy_reads[i])
+      {
+         if (first_mismatch < 0)
+            first_mismatch = i;
+
+         read_mismatches++;
+      }
+   }
+
+   for (unsigned i = 0; i < 64; i++)
+   {
+      if (eager_regs[i] != lazy_regs[i])
+      {
+         printf("%s %2u differs: 0x%08x eager, 0x%08x lazy\n", (i < 32) ? "DR" : "CR", i & 0x1F, eager_regs[i], lazy_regs[i]);
+         reg_mismatches++;
+      }
+   }
+
+   printf("%u instructions, %u CR 31 reads\n", count, (unsigned)eager_reads.size());
+   printf("  eager FLAGS: %8.2f ns/instruction\n", eager_time / (double)count);
+   printf("  lazy FLAGS:  %8.2f ns/instruction(%.2fx)\n", lazy_time / (double)count, lazy_time ? eager_time / (double)lazy_time : 0.0);
+
+   if (read_mismatches)
+      printf("CR 31 reads that differ: %u(first at read %d)\n", read_mismatches, first_mismatch);
+   else
+      printf("CR 31 reads match\n");
+
+   return (read_mismatches || reg_mismatches) ? 1 : 0;
+}